@@ -3,4 +3,6 @@ TEMPLATE = subdirs
 SUBDIRS += \
     EzGraverCore \
     EzGraverCli \
-    EzGraverUi
+    EzGraverUi \
+    EzGraverd \
+    EzGraverTests
@@ -1,7 +1,11 @@
 include(../common.pri)
 
 QT += core
+QT += gui
 QT += serialport
+QT += concurrent
+QT += svg
+QT += network
 
 TARGET = EzGraverCli
 CONFIG += console
@@ -1,5 +1,17 @@
-#include <QCoreApplication>
+#include <QGuiApplication>
 #include <QThread>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QFileInfo>
+#include <QFile>
+#include <QQueue>
+#include <QPair>
+#include <QDateTime>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <iterator>
 #include <algorithm>
@@ -8,6 +20,24 @@
 #include <exception>
 
 #include "ezgraver.h"
+#include "engravejob.h"
+#include "portwatcher.h"
+#include "imageloader.h"
+#include "framereader.h"
+#include "folderwatcher.h"
+#include "durationestimator.h"
+
+/*! The burn time used if none has been specified. */
+static int const DefaultBurnTime{60};
+
+/*! The minimal delay in milliseconds between two burn progress events. */
+static int const ProgressEventDelay{250};
+
+/*! The time in milliseconds to wait for the daemon to respond. */
+static int const DaemonTimeout{3000};
+
+/*! The image argument reading from stdin instead of a file. */
+static char const StdinName[]{"-"};
 
 std::ostream& operator<<(std::ostream& lhv, QString const& rhv) {
     return lhv << rhv.toStdString();
@@ -18,11 +48,19 @@ void showHelp() {
     std::cout << "Available options:\n";
     std::cout << "  v - Prints the version information\n";
     std::cout << "  a - Shows the available ports\n";
+    std::cout << "  m - Monitors the ports and prints every added or removed port\n";
     std::cout << "  h <port> - Moves the engraver to the home position\n";
     std::cout << "  s <port> - Starts the engraving process with the burn time 60\n";
     std::cout << "  p <port> - Pauses the engraver\n";
     std::cout << "  r <port> - Resets the engraver\n";
+    std::cout << "  g <port> <x> <y> - Moves the engraver to the given offset in steps (at most 512) from the home position\n";
     std::cout << "  u <port> <image> - Uploads the given image to the engraver\n";
+    std::cout << "  b <port> <image> [burn time] - Uploads and engraves the given image, printing progress as JSON lines\n";
+    std::cout << "  j <port> <image> [burn time] [priority] - Submits an engraving job to EzGraverd\n";
+    std::cout << "  e <image> [burn time] - Estimates the duration of engraving the given image\n";
+    std::cout << "  f <port> <pipe> [burn time] - Engraves every frame read from the given pipe, printing progress as JSON lines\n";
+    std::cout << "  w <port> <directory> [burn time] - Engraves every image dropped into the given directory, printing progress as JSON lines\n";
+    std::cout << "\nImages and pipes given as '-' are read from stdin.\n";
 }
 
 void showAvailablePorts() {
@@ -33,6 +71,28 @@ void showAvailablePorts() {
     std::cout << '\n';
 }
 
+void monitorPorts() {
+    PortWatcher watcher{};
+    QObject::connect(&watcher, &PortWatcher::portAdded, [](QString const& port) { std::cout << "+ " << port << std::endl; });
+    QObject::connect(&watcher, &PortWatcher::portRemoved, [](QString const& port) { std::cout << "- " << port << std::endl; });
+
+    QEventLoop loop{};
+    loop.exec();
+}
+
+std::shared_ptr<MappedBitmap> mapBitmap(QString const& fileName) {
+    return fileName == StdinName ? nullptr : MappedBitmap::open(fileName);
+}
+
+QImage loadImage(QString const& fileName) {
+    if(fileName != StdinName) {
+        return ImageLoader::load(fileName);
+    }
+
+    QFile input{};
+    return input.open(stdin, QIODevice::ReadOnly) ? ImageLoader::load(input.readAll()) : QImage{};
+}
+
 void uploadImage(std::shared_ptr<EzGraver>& engraver, QList<QString> const& arguments) {
     if(arguments.size() < 2) {
         std::cout << "No image provided\n";
@@ -40,8 +100,9 @@ void uploadImage(std::shared_ptr<EzGraver>& engraver, QList<QString> const& argu
     }
 
     auto fileName = arguments[1];
+    auto mapped = mapBitmap(fileName);
     QImage image{};
-    if(!image.load(fileName)) {
+    if(!mapped && (image = loadImage(fileName)).isNull()) {
         std::cout << "Error while loading image '" << fileName << "'\n";
         return;
     }
@@ -51,8 +112,272 @@ void uploadImage(std::shared_ptr<EzGraver>& engraver, QList<QString> const& argu
     engraver->awaitTransmission();
     QThread::msleep(EzGraver::EraseTimeMs);
 
-    std::cout << "uploading image to EEPROM\n";
-    engraver->uploadImage(image);
+    if(mapped) {
+        std::cout << "uploading monochrome bitmap to EEPROM\n";
+        engraver->uploadBitmap(mapped);
+    } else {
+        std::cout << "uploading image to EEPROM\n";
+        engraver->uploadImage(image);
+    }
+}
+
+void estimateDuration(QList<QString> const& arguments) {
+    auto burnTime = arguments.size() > 1 ? arguments[1].toInt() : DefaultBurnTime;
+    auto mapped = mapBitmap(arguments[0]);
+    QImage image{};
+    if(!mapped && (image = loadImage(arguments[0])).isNull()) {
+        std::cout << "Error while loading image '" << arguments[0] << "'\n";
+        return;
+    }
+
+    auto stats = mapped ? mapped->stats() : BitmapStats::analyze(EzGraver::convertImage(image));
+    DurationEstimator estimator{};
+    auto seconds = qRound(estimator.estimate(stats, burnTime));
+    std::cout << "estimated duration: " << seconds / 60 << "m " << seconds % 60 << "s ("
+              << stats.burnCount << " pixels in " << stats.rowCount << " rows and " << stats.spanCount << " spans, "
+              << "calibrated by " << estimator.jobCount() << " jobs)\n";
+}
+
+void printEvent(QElapsedTimer const& clock, QString const& type, QJsonObject event) {
+    event["event"] = type;
+    event["time"] = static_cast<double>(clock.elapsed());
+    std::cout << QJsonDocument{event}.toJson(QJsonDocument::Compact).constData() << std::endl;
+}
+
+bool runJob(QElapsedTimer const& clock, std::shared_ptr<EzGraver>& engraver, EngraveJob& job) {
+    printEvent(clock, "estimate", QJsonObject{{"burnCount", job.burnCount()}, {"seconds", job.estimatedTime()}});
+    auto printProgress = [&clock, &job, &engraver] {
+        printEvent(clock, "progress", QJsonObject{
+            {"state", EngraveJob::stateName(job.state())},
+            {"bytesSent", static_cast<double>(job.bytesSent())},
+            {"bytesTotal", static_cast<double>(job.bytesTotal())},
+            {"throughput", engraver->throughput()},
+            {"burned", job.burnedCount()},
+            {"burnCount", job.burnCount()},
+            {"burnRate", job.burnRate()},
+            {"eta", job.remainingTime()}
+        });
+    };
+
+    // Burn reports arrive for every single pixel, progress is therefore only printed periodically.
+    QTimer progressTimer{};
+    progressTimer.setInterval(ProgressEventDelay);
+    QObject::connect(&progressTimer, &QTimer::timeout, printProgress);
+    QObject::connect(&job, &EngraveJob::uploadProgressed, printProgress);
+    QObject::connect(&job, &EngraveJob::stateChanged, [&clock, &job, &progressTimer](EngraveJob::State state) {
+        printEvent(clock, "state", QJsonObject{{"state", EngraveJob::stateName(state)}, {"burnCount", job.burnCount()}});
+        if(state == EngraveJob::Burning) {
+            progressTimer.start();
+        }
+    });
+
+    QEventLoop loop{};
+    bool succeeded{false};
+    QObject::connect(&job, &EngraveJob::finished, [&clock, &job, &loop, &progressTimer, &succeeded, printProgress](bool success) {
+        progressTimer.stop();
+        printProgress();
+        printEvent(clock, "finished", QJsonObject{{"success", success}, {"state", EngraveJob::stateName(job.state())}});
+        succeeded = success;
+        loop.quit();
+    });
+
+    job.start();
+    loop.exec();
+    return succeeded;
+}
+
+void engraveImage(std::shared_ptr<EzGraver>& engraver, QList<QString> const& arguments) {
+    QElapsedTimer clock{};
+    clock.start();
+
+    if(arguments.size() < 2) {
+        printEvent(clock, "error", QJsonObject{{"message", "no image provided"}});
+        return;
+    }
+
+    auto burnTime = arguments.size() > 2 ? arguments[2].toInt() : DefaultBurnTime;
+    if(burnTime < 1 || burnTime > 0xF0) {
+        printEvent(clock, "error", QJsonObject{{"message", "burn time out of range"}});
+        return;
+    }
+
+    // Monochrome bitmaps are converted on their raw rows, anything else has to be decoded first.
+    auto mapped = mapBitmap(arguments[1]);
+    QImage image{};
+    if(!mapped && (image = loadImage(arguments[1])).isNull()) {
+        printEvent(clock, "error", QJsonObject{{"message", QString{"failed to load image '%1'"}.arg(arguments[1])}});
+        return;
+    }
+
+    std::unique_ptr<EngraveJob> job{mapped
+            ? new EngraveJob{engraver, mapped, burnTime}
+            : new EngraveJob{engraver, EzGraver::convertImage(image), burnTime}};
+    runJob(clock, engraver, *job);
+}
+
+void streamFrames(std::shared_ptr<EzGraver>& engraver, QList<QString> const& arguments) {
+    QElapsedTimer clock{};
+    clock.start();
+
+    if(arguments.size() < 2) {
+        printEvent(clock, "error", QJsonObject{{"message", "no pipe provided"}});
+        return;
+    }
+
+    auto burnTime = arguments.size() > 2 ? arguments[2].toInt() : DefaultBurnTime;
+    if(burnTime < 1 || burnTime > 0xF0) {
+        printEvent(clock, "error", QJsonObject{{"message", "burn time out of range"}});
+        return;
+    }
+
+    auto const source = arguments[1];
+    QFile input{source};
+    auto openInput = [&input, &source] {
+        return source == StdinName ? input.open(stdin, QIODevice::ReadOnly) : input.open(QIODevice::ReadOnly);
+    };
+    if(!openInput()) {
+        printEvent(clock, "error", QJsonObject{{"message", QString{"failed to open '%1'"}.arg(source)}});
+        return;
+    }
+
+    FrameReader reader{input};
+    forever {
+        QImage image{};
+        try {
+            if(!reader.next(image)) {
+                // Named pipes end whenever their writer closes them, the next writer continues the stream.
+                if(source == StdinName || !input.isSequential()) {
+                    break;
+                }
+                input.close();
+                if(!openInput()) {
+                    break;
+                }
+                continue;
+            }
+        } catch(std::exception const& e) {
+            printEvent(clock, "error", QJsonObject{{"message", e.what()}});
+            break;
+        }
+
+        printEvent(clock, "frame", QJsonObject{{"frame", reader.frameCount()}, {"width", image.width()}, {"height", image.height()}});
+        EngraveJob job{engraver, EzGraver::convertImage(image), burnTime};
+        if(!runJob(clock, engraver, job)) {
+            break;
+        }
+    }
+}
+
+void watchFolder(std::shared_ptr<EzGraver>& engraver, QList<QString> const& arguments) {
+    QElapsedTimer clock{};
+    clock.start();
+
+    if(arguments.size() < 2) {
+        printEvent(clock, "error", QJsonObject{{"message", "no directory provided"}});
+        return;
+    }
+
+    auto burnTime = arguments.size() > 2 ? arguments[2].toInt() : DefaultBurnTime;
+    if(burnTime < 1 || burnTime > 0xF0) {
+        printEvent(clock, "error", QJsonObject{{"message", "burn time out of range"}});
+        return;
+    }
+
+    // Completed files are converted on the thread pool right away while the engraver is still busy.
+    QQueue<QPair<QString, QFuture<QImage>>> pending{};
+    bool busy{false};
+    auto processPending = [&] {
+        if(busy) {
+            return;
+        }
+        busy = true;
+        while(!pending.isEmpty()) {
+            auto next = pending.dequeue();
+            auto bitmap = next.second.result();
+            QJsonObject record{
+                {"image", next.first},
+                {"port", arguments[0]},
+                {"burnTime", burnTime},
+                {"started", QDateTime::currentDateTime().toString(Qt::ISODate)}
+            };
+
+            bool success{false};
+            if(bitmap.isNull()) {
+                record["error"] = "failed to load image";
+                printEvent(clock, "error", QJsonObject{{"message", QString{"failed to load image '%1'"}.arg(next.first)}});
+            } else {
+                printEvent(clock, "file", QJsonObject{{"image", next.first}});
+                EngraveJob job{engraver, bitmap, burnTime};
+                success = runJob(clock, engraver, job);
+                record["state"] = EngraveJob::stateName(job.state());
+                record["burned"] = job.burnedCount();
+                record["burnCount"] = job.burnCount();
+            }
+            record["success"] = success;
+            record["finished"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+            auto archived = FolderWatcher::archive(next.first, success, record);
+            printEvent(clock, "archived", QJsonObject{{"image", next.first}, {"archive", archived}, {"success", success}});
+        }
+        busy = false;
+    };
+
+    FolderWatcher watcher{arguments[1]};
+    QObject::connect(&watcher, &FolderWatcher::fileReady, [&pending, processPending](QString const& fileName) {
+        pending.enqueue(qMakePair(fileName, QtConcurrent::run([fileName] {
+            auto image = ImageLoader::load(fileName);
+            return image.isNull() ? QImage{} : EzGraver::convertImage(image);
+        })));
+        // Files arriving while a job runs are picked up by the loop already processing the queue.
+        processPending();
+    });
+    if(!watcher.start()) {
+        printEvent(clock, "error", QJsonObject{{"message", QString{"failed to watch '%1'"}.arg(arguments[1])}});
+        return;
+    }
+
+    printEvent(clock, "watching", QJsonObject{{"directory", watcher.directory()}});
+    QEventLoop loop{};
+    loop.exec();
+}
+
+void submitJob(QList<QString> const& arguments) {
+    if(arguments.size() < 2) {
+        std::cout << "No image provided\n";
+        return;
+    }
+
+    QJsonObject request{
+        {"command", "submit"},
+        {"port", arguments[0]},
+        {"image", QFileInfo{arguments[1]}.absoluteFilePath()},
+        {"burnTime", arguments.size() > 2 ? arguments[2].toInt() : DefaultBurnTime},
+        {"priority", arguments.size() > 3 ? arguments[3].toInt() : 0}
+    };
+
+    QLocalSocket socket{};
+    auto socketName = qEnvironmentVariableIsSet("EZGRAVERD_SOCKET") ? QString::fromLocal8Bit(qgetenv("EZGRAVERD_SOCKET")) : QString{"ezgraverd"};
+    socket.connectToServer(socketName);
+    if(!socket.waitForConnected(DaemonTimeout)) {
+        std::cout << "Error: failed to connect to EzGraverd (" << socket.errorString() << ")\n";
+        return;
+    }
+
+    socket.write(QJsonDocument{request}.toJson(QJsonDocument::Compact));
+    socket.write("\n");
+    socket.flush();
+
+    // Status events of other jobs may be pushed before the reply arrives.
+    while(socket.waitForReadyRead(DaemonTimeout)) {
+        while(socket.canReadLine()) {
+            auto line = socket.readLine();
+            if(QJsonDocument::fromJson(line).object().contains("reply")) {
+                std::cout << line.constData();
+                return;
+            }
+        }
+    }
+    std::cout << "Error: EzGraverd did not respond\n";
 }
 
 void processCommand(char const& command, QList<QString> const& arguments) {
@@ -72,12 +397,28 @@ void processCommand(char const& command, QList<QString> const& arguments) {
         case 'r':
             engraver->reset();
             break;
+        case 'g':
+            if(arguments.size() < 3) {
+                std::cout << "No offset provided\n";
+                break;
+            }
+            engraver->moveTo(arguments[1].toInt(), arguments[2].toInt());
+            break;
         case 'p':
             engraver->pause();
             break;
         case 'u':
             uploadImage(engraver, arguments);
             break;
+        case 'b':
+            engraveImage(engraver, arguments);
+            break;
+        case 'f':
+            streamFrames(engraver, arguments);
+            break;
+        case 'w':
+            watchFolder(engraver, arguments);
+            break;
         default:
             std::cout << "Unknown command: '" << command << "'\n";
             showHelp();
@@ -100,6 +441,9 @@ void handleArguments(QStringList const& arguments) {
     case 'a':
         showAvailablePorts();
         return;
+    case 'm':
+        monitorPorts();
+        return;
     case 'v':
         std::cout << "EzGraver " << EZ_VERSION << '\n';
         return;
@@ -110,11 +454,23 @@ void handleArguments(QStringList const& arguments) {
         return;
     }
 
+    if(command == 'e') {
+        estimateDuration(arguments.mid(2));
+        return;
+    }
+
+    if(command == 'j') {
+        submitJob(arguments.mid(2));
+        return;
+    }
+
     processCommand(command, arguments.mid(2));
 }
 
 int main(int argc, char* argv[]) {
-    QCoreApplication app{argc, argv};
+    // Text within vector images needs the font database of a GUI application.
+    ImageLoader::useOffscreenPlatform();
+    QGuiApplication app{argc, argv};
 
     QStringList arguments{};
     std::copy(argv, argv+argc, std::back_insert_iterator<QStringList>(arguments));
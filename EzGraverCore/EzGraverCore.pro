@@ -2,6 +2,8 @@ include(../common.pri)
 
 QT += core
 QT += serialport
+QT += concurrent
+QT += svg
 
 TARGET = EzGraverCore
 TEMPLATE = lib
@@ -9,10 +11,61 @@ CONFIG += staticlib
 
 DEFINES += EZGRAVERCORE_LIBRARY
 
-SOURCES += ezgraver.cpp
+# The image processing loops are written to be vectorized by the compiler.
+!msvc: QMAKE_CXXFLAGS_RELEASE += -O3
+
+SOURCES += ezgraver.cpp \
+    report.cpp \
+    bitmapstats.cpp \
+    engravejob.cpp \
+    portwatcher.cpp \
+    folderwatcher.cpp \
+    mappedbitmap.cpp \
+    parallel.cpp \
+    tone.cpp \
+    edgedetector.cpp \
+    adaptivethreshold.cpp \
+    binarizer.cpp \
+    imageloader.cpp \
+    framereader.cpp \
+    bitmapcache.cpp \
+    comparison.cpp \
+    burntelemetry.cpp \
+    durationestimator.cpp \
+    budget.cpp \
+    nesting.cpp \
+    burnsimulator.cpp \
+    burnprogress.cpp \
+    layoutoptimizer.cpp \
+    filterpipeline.cpp
 
 HEADERS += ezgraver.h\
-        ezgravercore_global.h
+        ezgravercore_global.h \
+    report.h \
+    bitmapstats.h \
+    engravejob.h \
+    portwatcher.h \
+    folderwatcher.h \
+    mappedbitmap.h \
+    spscqueue.h \
+    parallel.h \
+    tone.h \
+    edgedetector.h \
+    adaptivethreshold.h \
+    binarizer.h \
+    imageloader.h \
+    framereader.h \
+    bitmapcache.h \
+    comparison.h \
+    burntelemetry.h \
+    durationestimator.h \
+    budget.h \
+    nesting.h \
+    burnsimulator.h \
+    burnprogress.h \
+    layoutoptimizer.h \
+    filterstage.h \
+    filterpipeline.h
 
 unix {
     target.path = /usr/lib
@@ -0,0 +1,77 @@
+#include "adaptivethreshold.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "parallel.h"
+#include "tone.h"
+
+bool ThresholdSettings::operator==(ThresholdSettings const& other) const {
+    return window == other.window && k == other.k;
+}
+
+bool ThresholdSettings::operator!=(ThresholdSettings const& other) const {
+    return !(*this == other);
+}
+
+QImage AdaptiveThreshold::apply(QImage const& image, ThresholdSettings const& settings) {
+    auto const gray = image.format() == QImage::Format_Grayscale8 ? image : Tone::grayscale(image, ToneSettings{});
+    auto const width = gray.width();
+    auto const height = gray.height();
+    auto const stride = width + 1;
+
+    // Summed area tables of the values and their squares with a leading row and column of zeros.
+    std::vector<qint64> sums(stride * (height + 1), 0);
+    std::vector<qint64> squares(stride * (height + 1), 0);
+    Parallel::forEachBand(height, [&](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto line = gray.constScanLine(y);
+            auto sum = &sums[(y + 1) * stride];
+            auto square = &squares[(y + 1) * stride];
+            for(int x{0}; x < width; ++x) {
+                sum[x + 1] = sum[x] + line[x];
+                square[x + 1] = square[x] + line[x] * line[x];
+            }
+        }
+    });
+    for(int y{1}; y <= height; ++y) {
+        auto sum = &sums[y * stride];
+        auto square = &squares[y * stride];
+        for(int x{1}; x <= width; ++x) {
+            sum[x] += sum[x - stride];
+            square[x] += square[x - stride];
+        }
+    }
+
+    QImage raster{gray.size(), QImage::Format_Mono};
+    raster.setColorTable(QVector<QRgb>{qRgb(255, 255, 255), qRgb(0, 0, 0)});
+    auto const radius = std::max(1, settings.window / 2);
+    auto const k = settings.k;
+    Parallel::forEachBand(height, [&](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto const top = std::max(0, y - radius);
+            auto const bottom = std::min(height, y + radius + 1);
+            auto line = gray.constScanLine(y);
+            auto out = raster.scanLine(y);
+            std::fill(out, out + raster.bytesPerLine(), 0);
+            for(int x{0}; x < width; ++x) {
+                auto const left = std::max(0, x - radius);
+                auto const right = std::min(width, x + radius + 1);
+                auto const count = static_cast<double>((bottom - top) * (right - left));
+                auto const sum = sums[bottom*stride + right] - sums[top*stride + right]
+                        - sums[bottom*stride + left] + sums[top*stride + left];
+                auto const square = squares[bottom*stride + right] - squares[top*stride + right]
+                        - squares[bottom*stride + left] + squares[top*stride + left];
+
+                auto const mean = sum / count;
+                auto const deviation = std::sqrt(std::max(0.0, square / count - mean * mean));
+                auto const threshold = mean * (1 + k * (deviation / DeviationRange - 1));
+                if(line[x] <= threshold) {
+                    out[x >> 3] |= 0x80 >> (x & 7);
+                }
+            }
+        }
+    });
+    return raster;
+}
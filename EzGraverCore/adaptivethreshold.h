@@ -0,0 +1,45 @@
+#ifndef ADAPTIVETHRESHOLD_H
+#define ADAPTIVETHRESHOLD_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QMetaType>
+
+/*!
+ * The settings of the adaptive thresholding.
+ */
+struct EZGRAVERCORESHARED_EXPORT ThresholdSettings {
+    /*! The edge length of the square window the local statistics are computed in. */
+    int window{31};
+
+    /*! The sensitivity to the local contrast, higher values burn less of flat areas. */
+    double k{0.2};
+
+    bool operator==(ThresholdSettings const& other) const;
+    bool operator!=(ThresholdSettings const& other) const;
+};
+
+Q_DECLARE_METATYPE(ThresholdSettings)
+
+/*!
+ * Binarizes images with a local threshold using the method of Sauvola. The mean and
+ * the standard deviation of each window are looked up in constant time from summed
+ * area tables, so the costs do not depend on the window size. Pixels are processed
+ * in parallel bands of rows.
+ */
+struct EZGRAVERCORESHARED_EXPORT AdaptiveThreshold {
+    /*! The dynamic range of the standard deviation of 8-bit images. */
+    static constexpr double DeviationRange{128.0};
+
+    /*!
+     * Binarizes the given \a image.
+     *
+     * \param image The image to process, it is converted to grayscale if necessary.
+     * \param settings The settings of the thresholding.
+     * \return The image in the format \c QImage::Format_Mono with black pixels to be burned.
+     */
+    static QImage apply(QImage const& image, ThresholdSettings const& settings);
+};
+
+#endif // ADAPTIVETHRESHOLD_H
@@ -0,0 +1,13 @@
+#include "binarizer.h"
+
+QImage Binarizer::apply(QImage const& image, BinarizerSettings const& settings) {
+    switch(settings.mode) {
+    case BinarizerSettings::Edges:
+        return EdgeDetector::detect(image, settings.edges);
+    case BinarizerSettings::Adaptive:
+        return AdaptiveThreshold::apply(image, settings.threshold);
+    case BinarizerSettings::Dither:
+    default:
+        return image.convertToFormat(QImage::Format_Mono, settings.flags);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef BINARIZER_H
+#define BINARIZER_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QMetaType>
+
+#include "edgedetector.h"
+#include "adaptivethreshold.h"
+
+/*!
+ * The settings used to turn an image into a monochrome raster.
+ */
+struct EZGRAVERCORESHARED_EXPORT BinarizerSettings {
+    /*!
+     * The available conversion modes.
+     */
+    enum Mode {
+        /*! Dithers the image using the Qt conversion flags. */
+        Dither,
+        /*! Engraves the outlines of the image only. */
+        Edges,
+        /*! Thresholds every pixel against the statistics of its neighborhood. */
+        Adaptive
+    };
+
+    /*! The conversion mode. */
+    Mode mode{Dither};
+
+    /*! The conversion flags used by \a Dither. */
+    Qt::ImageConversionFlags flags{Qt::DiffuseDither};
+
+    /*! The settings used by \a Edges. */
+    EdgeSettings edges{};
+
+    /*! The settings used by \a Adaptive. */
+    ThresholdSettings threshold{};
+};
+
+Q_DECLARE_METATYPE(BinarizerSettings::Mode)
+
+/*!
+ * Turns images into monochrome rasters according to the selected mode.
+ */
+struct EZGRAVERCORESHARED_EXPORT Binarizer {
+    /*!
+     * Binarizes the given \a image.
+     *
+     * \param image The image to convert.
+     * \param settings The settings of the conversion.
+     * \return The image in the format \c QImage::Format_Mono with black pixels to be burned.
+     */
+    static QImage apply(QImage const& image, BinarizerSettings const& settings);
+};
+
+#endif // BINARIZER_H
@@ -0,0 +1,174 @@
+#include "bitmapcache.h"
+
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <utime.h>
+#endif
+
+#include "ezgraver.h"
+
+namespace {
+
+/*! Identifies the entries of the cache, to be changed whenever their layout changes. */
+quint32 const Magic{0x457A4243};
+quint32 const Version{2};
+
+QString const Suffix{".ezbc"};
+
+void touch(QString const& path) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    QFile file{path};
+    if(file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+#elif defined(Q_OS_UNIX)
+    utime(QFile::encodeName(path).constData(), nullptr);
+#else
+    Q_UNUSED(path);
+#endif
+}
+
+}
+
+BitmapCache::BitmapCache(QString const& directory, qint64 maxSize)
+    : _directory{directory.isEmpty()
+                 ? QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/bitmaps"
+                 : directory}
+    , _maxSize{maxSize}
+    , _stores{0} {
+    QDir{}.mkpath(_directory);
+}
+
+QByteArray BitmapCache::hashFile(QString const& fileName) {
+    QFile file{fileName};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return QByteArray{};
+    }
+
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+    return hash.addData(&file) ? hash.result() : QByteArray{};
+}
+
+QByteArray BitmapCache::key(QByteArray const& sourceHash, QByteArray const& parameters) {
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+    hash.addData(sourceHash);
+    hash.addData(parameters);
+    return hash.result().toHex();
+}
+
+bool BitmapCache::contains(QByteArray const& key) const {
+    return !key.isEmpty() && QFile::exists(_path(key));
+}
+
+bool BitmapCache::lookup(QByteArray const& key, QImage& bitmap, BitmapStats& stats) const {
+    if(key.isEmpty()) {
+        return false;
+    }
+
+    auto const path = _path(key);
+    QFile file{path};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream{&file};
+    quint32 magic, version;
+    qint32 burnCount, x, y, width, height, rowCount, spanCount;
+    stream >> magic >> version >> burnCount >> x >> y >> width >> height >> rowCount >> spanCount;
+    if(stream.status() != QDataStream::Ok || magic != Magic || version != Version) {
+        qDebug() << "discarding invalid cache entry" << path;
+        file.remove();
+        return false;
+    }
+
+    QImage image{EzGraver::ImageWidth, EzGraver::ImageHeight, QImage::Format_Mono};
+    image.setColorTable(QVector<QRgb>{qRgb(255, 255, 255), qRgb(0, 0, 0)});
+    auto const lineSize = (EzGraver::ImageWidth + 7) / 8;
+    for(int row{0}; row < image.height(); ++row) {
+        if(stream.readRawData(reinterpret_cast<char*>(image.scanLine(row)), lineSize) != lineSize) {
+            qDebug() << "discarding truncated cache entry" << path;
+            file.remove();
+            return false;
+        }
+    }
+    file.close();
+    touch(path);
+
+    bitmap = image;
+    stats = BitmapStats{burnCount, QRect{x, y, width, height}, rowCount, spanCount};
+    return true;
+}
+
+void BitmapCache::store(QByteArray const& key, QImage const& bitmap, BitmapStats const& stats) {
+    if(bitmap.format() != QImage::Format_Mono || bitmap.size() != QSize{EzGraver::ImageWidth, EzGraver::ImageHeight}) {
+        qDebug() << "not caching bitmap of unexpected format";
+        return;
+    }
+
+    // Normalize the palette to the one restored by lookup, white pixels being burned.
+    auto const flip = BitmapStats::burnBit(bitmap) == 1;
+    QSaveFile file{_path(key)};
+    if(!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "failed to write cache entry" << file.fileName();
+        return;
+    }
+
+    QDataStream stream{&file};
+    stream << Magic << Version << static_cast<qint32>(stats.burnCount)
+           << static_cast<qint32>(stats.bounds.x()) << static_cast<qint32>(stats.bounds.y())
+           << static_cast<qint32>(stats.bounds.width()) << static_cast<qint32>(stats.bounds.height())
+           << static_cast<qint32>(stats.rowCount) << static_cast<qint32>(stats.spanCount);
+
+    auto const lineSize = (EzGraver::ImageWidth + 7) / 8;
+    QByteArray line(lineSize, '\0');
+    for(int row{0}; row < bitmap.height(); ++row) {
+        auto bits = bitmap.constScanLine(row);
+        for(int i{0}; i < lineSize; ++i) {
+            line[i] = static_cast<char>(flip ? ~bits[i] : bits[i]);
+        }
+        stream.writeRawData(line.constData(), lineSize);
+    }
+    if(!file.commit()) {
+        qDebug() << "failed to commit cache entry" << file.fileName();
+        return;
+    }
+
+    // Listing and sorting the whole directory is only worth it once in a while.
+    if(_stores++ % EvictionInterval == 0) {
+        _evict();
+    }
+}
+
+QString BitmapCache::directory() const {
+    return _directory;
+}
+
+QString BitmapCache::_path(QByteArray const& key) const {
+    return QDir{_directory}.filePath(QString::fromLatin1(key) + Suffix);
+}
+
+void BitmapCache::_evict() {
+    auto entries = QDir{_directory}.entryInfoList(QStringList{"*" + Suffix}, QDir::Files, QDir::Time);
+    qint64 size{0};
+    for(auto const& entry : entries) {
+        size += entry.size();
+    }
+
+    // The entries are sorted by their modification time, most recently used first.
+    while(size > _maxSize && !entries.isEmpty()) {
+        auto const entry = entries.takeLast();
+        qDebug() << "evicting cache entry" << entry.fileName();
+        if(QFile::remove(entry.absoluteFilePath())) {
+            size -= entry.size();
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef BITMAPCACHE_H
+#define BITMAPCACHE_H
+
+#include "ezgravercore_global.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QImage>
+
+#include <atomic>
+
+#include "bitmapstats.h"
+
+/*!
+ * A persistent, size bounded cache of device ready bitmaps. Entries are keyed by the hash
+ * of the source file and the parameters of the processing pipeline, so reopening a known
+ * design with known settings only reads the 1-bit raster back. The least recently used
+ * entries are evicted once the cache exceeds its size, checked every \a EvictionInterval
+ * stores. Entries may be stored from any thread.
+ */
+class EZGRAVERCORESHARED_EXPORT BitmapCache {
+public:
+    /*! The default maximum size of the cache in bytes. */
+    static qint64 const DefaultMaxSize{64 * 1024 * 1024};
+
+    /*! The number of stores between two checks of the size of the cache. */
+    static int const EvictionInterval{16};
+
+    /*!
+     * Creates a cache stored in the given \a directory.
+     *
+     * \param directory The directory holding the entries, the users cache location if empty.
+     * \param maxSize The maximum size of all entries in bytes.
+     */
+    explicit BitmapCache(QString const& directory=QString{}, qint64 maxSize=DefaultMaxSize);
+
+    /*!
+     * Hashes the content of the given file.
+     *
+     * \param fileName The file to hash.
+     * \return The hash or an empty array if the file could not be read.
+     */
+    static QByteArray hashFile(QString const& fileName);
+
+    /*!
+     * Builds the key of an entry.
+     *
+     * \param sourceHash The hash of the source as returned by \a hashFile.
+     * \param parameters The serialized parameters of the processing pipeline.
+     * \return The key of the entry.
+     */
+    static QByteArray key(QByteArray const& sourceHash, QByteArray const& parameters);
+
+    /*!
+     * Checks if an entry with the given \a key exists without reading it.
+     *
+     * \param key The key of the entry.
+     * \return \c true if the entry exists.
+     */
+    bool contains(QByteArray const& key) const;
+
+    /*!
+     * Looks up the entry with the given \a key and marks it as recently used.
+     *
+     * \param key The key of the entry.
+     * \param bitmap Receives the device ready bitmap.
+     * \param stats Receives the statistics of the bitmap.
+     * \return \c true if the entry has been found.
+     */
+    bool lookup(QByteArray const& key, QImage& bitmap, BitmapStats& stats) const;
+
+    /*!
+     * Stores the given device ready \a bitmap. Every \a EvictionInterval stores, old
+     * entries are evicted if necessary.
+     *
+     * \param key The key of the entry.
+     * \param bitmap The 512x512 monochrome device ready bitmap.
+     * \param stats The statistics of the bitmap.
+     */
+    void store(QByteArray const& key, QImage const& bitmap, BitmapStats const& stats);
+
+    /*!
+     * Gets the directory holding the entries.
+     *
+     * \return The directory of the cache.
+     */
+    QString directory() const;
+
+private:
+    QString _directory;
+    qint64 _maxSize;
+    std::atomic<int> _stores;
+
+    QString _path(QByteArray const& key) const;
+    void _evict();
+};
+
+#endif // BITMAPCACHE_H
@@ -0,0 +1,79 @@
+#include "bitmapstats.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+namespace {
+
+/*! Gets the offset of the leftmost set bit of a MSB first \a byte. */
+int firstBit(uchar byte) {
+    int i{0};
+    while(!(byte & (0x80 >> i))) {
+        ++i;
+    }
+    return i;
+}
+
+/*! Gets the offset of the rightmost set bit of a MSB first \a byte. */
+int lastBit(uchar byte) {
+    int i{7};
+    while(!(byte & (0x80 >> i))) {
+        --i;
+    }
+    return i;
+}
+
+}
+
+BitmapStats BitmapStats::analyze(QImage const& bitmap) {
+    if(bitmap.format() != QImage::Format_Mono) {
+        return BitmapStats{0, QRect{}, 0, 0};
+    }
+    return analyze(bitmap.constBits(), bitmap.width(), bitmap.height(), bitmap.bytesPerLine(), burnBit(bitmap));
+}
+
+BitmapStats BitmapStats::analyze(uchar const* bits, int width, int height, int bytesPerLine, int burnValue) {
+    BitmapStats stats{0, QRect{}, 0, 0};
+    uchar const flip = burnValue ? 0x00 : 0xFF;
+    auto const bytes = (width + 7) / 8;
+    uchar const tailMask = width % 8 ? static_cast<uchar>(0xFF << (8 - width % 8)) : 0xFF;
+
+    int x0{width}, y0{-1}, x1{-1}, y1{-1};
+    for(int y{0}; y < height; ++y) {
+        auto line = bits + y * bytesPerLine;
+        uchar previous{0};
+        for(int i{0}; i < bytes; ++i) {
+            uchar byte = line[i] ^ flip;
+            if(i == bytes - 1) {
+                byte &= tailMask;
+            }
+            if(!byte) {
+                previous = 0;
+                continue;
+            }
+
+            // A span starts at every burned pixel whose left neighbour is not burned.
+            stats.spanCount += qPopulationCount(quint8(byte & ~((byte >> 1) | (previous << 7))));
+            previous = byte & 0x01;
+            stats.rowCount += y1 == y ? 0 : 1;
+            stats.burnCount += qPopulationCount(quint8(byte));
+            x0 = std::min(x0, i*8 + firstBit(byte));
+            x1 = std::max(x1, i*8 + lastBit(byte));
+            y0 = y0 < 0 ? y : y0;
+            y1 = y;
+        }
+    }
+
+    if(stats.burnCount > 0) {
+        stats.bounds = QRect{QPoint{x0, y0}, QPoint{x1, y1}};
+    }
+    return stats;
+}
+
+int BitmapStats::burnBit(QImage const& bitmap) {
+    if(bitmap.colorCount() < 2) {
+        return 1;
+    }
+    return qGray(bitmap.color(1)) > qGray(bitmap.color(0)) ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+#ifndef BITMAPSTATS_H
+#define BITMAPSTATS_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QRect>
+
+/*!
+ * Statistics of a device ready bitmap as produced by \a EzGraver::convertImage.
+ * Every white pixel of such a bitmap is being engraved.
+ */
+struct EZGRAVERCORESHARED_EXPORT BitmapStats {
+    /*! The number of pixels being burned. */
+    int burnCount;
+
+    /*! The bounding box of all burned pixels in bitmap coordinates, empty if nothing is burned. */
+    QRect bounds;
+
+    /*! The number of rows containing at least one burned pixel. */
+    int rowCount;
+
+    /*! The number of horizontal runs of consecutive burned pixels. */
+    int spanCount;
+
+    /*!
+     * Analyzes the given monochrome \a bitmap by scanning its raw bits.
+     *
+     * \param bitmap The device ready bitmap to analyze.
+     * \return The statistics of the bitmap.
+     */
+    static BitmapStats analyze(QImage const& bitmap);
+
+    /*!
+     * Analyzes the raw rows of a monochrome bitmap with the most significant bit first,
+     * e.g. the pixel data of an encoded file.
+     *
+     * \param bits The first byte of the top row.
+     * \param width The number of pixels per row.
+     * \param height The number of rows.
+     * \param bytesPerLine The distance between two rows in bytes, negative for bottom-up rows.
+     * \param burnValue The bit value representing a burned pixel.
+     * \return The statistics of the bitmap.
+     */
+    static BitmapStats analyze(uchar const* bits, int width, int height, int bytesPerLine, int burnValue);
+
+    /*!
+     * Gets the bit value representing a burned pixel in the given \a bitmap.
+     *
+     * \param bitmap The monochrome bitmap to inspect.
+     * \return \c 1 if set bits are burned, \c 0 otherwise.
+     */
+    static int burnBit(QImage const& bitmap);
+};
+
+#endif // BITMAPSTATS_H
@@ -0,0 +1,98 @@
+#include "budget.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <array>
+
+#include "parallel.h"
+#include "tone.h"
+
+bool BudgetSettings::isActive() const {
+    return maxPixels > 0 || maxSeconds > 0;
+}
+
+bool BudgetSettings::operator==(BudgetSettings const& other) const {
+    return maxPixels == other.maxPixels && maxSeconds == other.maxSeconds && burnTime == other.burnTime;
+}
+
+bool BudgetSettings::operator!=(BudgetSettings const& other) const {
+    return !(*this == other);
+}
+
+BudgetResult Budget::fit(QImage const& image, BinarizerSettings const& settings,
+                         BudgetSettings const& budget, DurationEstimator const& estimator) {
+    auto const gray = image.format() == QImage::Format_Grayscale8 ? image : Tone::grayscale(image, ToneSettings{});
+    int iterations{0};
+    auto const evaluate = [&](int offset) {
+        BudgetResult candidate{offset, convert(gray, settings, offset), BitmapStats{0, QRect{}, 0, 0}, false, ++iterations};
+        candidate.stats = analyze(candidate.raster);
+        candidate.fits = (budget.maxPixels <= 0 || candidate.stats.burnCount <= budget.maxPixels)
+                && (budget.maxSeconds <= 0 || estimator.estimate(candidate.stats, budget.burnTime) <= budget.maxSeconds);
+        return candidate;
+    };
+
+    // The unchanged conversion is the best looking one if it already fits.
+    auto best = evaluate(0);
+    if(best.fits || !budget.isActive()) {
+        return best;
+    }
+    best = evaluate(MaximumOffset);
+    if(!best.fits) {
+        qDebug() << "budget cannot be met, burning" << best.stats.burnCount << "pixels at least";
+        return best;
+    }
+
+    int low{0}, high{MaximumOffset};
+    while(high - low > 1) {
+        auto const middle = (low + high) / 2;
+        auto candidate = evaluate(middle);
+        if(candidate.fits) {
+            high = middle;
+            best = candidate;
+        } else {
+            low = middle;
+        }
+    }
+
+    best.iterations = iterations;
+    qDebug() << "fitted budget with offset" << best.offset << "after" << iterations << "iterations";
+    return best;
+}
+
+QImage Budget::convert(QImage const& image, BinarizerSettings const& settings, int offset) {
+    if(offset == 0) {
+        return Binarizer::apply(image, settings);
+    }
+
+    if(settings.mode == BinarizerSettings::Edges) {
+        auto shifted = settings;
+        shifted.edges.lowThreshold += offset;
+        shifted.edges.highThreshold += offset;
+        return Binarizer::apply(image, shifted);
+    }
+
+    std::array<uchar, 256> table{};
+    for(int i{0}; i < 256; ++i) {
+        table[i] = static_cast<uchar>(std::min(255, i + offset));
+    }
+
+    auto brightened = image.copy();
+    auto const width = brightened.width();
+    Parallel::forEachBand(brightened.height(), [&brightened, &table, width](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto line = brightened.scanLine(y);
+            for(int x{0}; x < width; ++x) {
+                line[x] = table[line[x]];
+            }
+        }
+    });
+    return Binarizer::apply(brightened, settings);
+}
+
+BitmapStats Budget::analyze(QImage const& raster) {
+    // BitmapStats counts the brighter pixels of device bitmaps, converted images burn the darker ones.
+    auto inverted = raster.copy();
+    inverted.invertPixels();
+    return BitmapStats::analyze(inverted);
+}
@@ -0,0 +1,99 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QMetaType>
+
+#include "binarizer.h"
+#include "bitmapstats.h"
+#include "durationestimator.h"
+
+/*!
+ * The limits a job has to fit into.
+ */
+struct EZGRAVERCORESHARED_EXPORT BudgetSettings {
+    /*! The maximum number of burned pixels, \c 0 if unlimited. */
+    int maxPixels{0};
+
+    /*! The maximum estimated duration of the burn phase in seconds, \c 0 if unlimited. */
+    double maxSeconds{0.0};
+
+    /*! The burn time the duration is estimated for. */
+    int burnTime{60};
+
+    /*!
+     * Checks if any limit is set.
+     *
+     * \return \c true if the budget restricts the job.
+     */
+    bool isActive() const;
+
+    bool operator==(BudgetSettings const& other) const;
+    bool operator!=(BudgetSettings const& other) const;
+};
+
+Q_DECLARE_METATYPE(BudgetSettings)
+
+/*!
+ * The outcome of fitting an image into a budget.
+ */
+struct EZGRAVERCORESHARED_EXPORT BudgetResult {
+    /*! The applied offset, the brightness for dithering or the thresholds for edges. */
+    int offset;
+
+    /*! The converted image in the format \c QImage::Format_Mono with black pixels to be burned. */
+    QImage raster;
+
+    /*! The statistics of the converted image. */
+    BitmapStats stats;
+
+    /*! \c true if the budget is met, otherwise the raster is the sparsest one possible. */
+    bool fits;
+
+    /*! The number of conversions performed by the search. */
+    int iterations;
+};
+
+/*!
+ * Fits a conversion into a budget by searching the smallest offset of its parameter
+ * that results in few enough burned pixels. Brighter images and higher edge thresholds
+ * burn fewer pixels, which allows a binary search over popcount based burn counts.
+ */
+struct EZGRAVERCORESHARED_EXPORT Budget {
+    /*! The largest offset searched. */
+    static int const MaximumOffset{255};
+
+    /*!
+     * Fits the given \a image into the \a budget.
+     *
+     * \param image The image as it is passed to the binarization.
+     * \param settings The settings of the conversion.
+     * \param budget The limits to meet.
+     * \param estimator The estimator used for duration limits.
+     * \return The least changed conversion meeting the budget.
+     */
+    static BudgetResult fit(QImage const& image, BinarizerSettings const& settings,
+                            BudgetSettings const& budget, DurationEstimator const& estimator);
+
+    /*!
+     * Converts the given grayscale \a image with the parameter shifted by \a offset.
+     *
+     * \param image The image in the format \c QImage::Format_Grayscale8.
+     * \param settings The settings of the conversion.
+     * \param offset The offset to apply.
+     * \return The converted image in the format \c QImage::Format_Mono with black pixels to be burned.
+     */
+    static QImage convert(QImage const& image, BinarizerSettings const& settings, int offset);
+
+    /*!
+     * Counts the burned, i.e. black, pixels of a converted image.
+     *
+     * \param raster The converted image in the format \c QImage::Format_Mono.
+     * \return The statistics of the burned pixels.
+     */
+    static BitmapStats analyze(QImage const& raster);
+};
+
+#endif // BUDGET_H
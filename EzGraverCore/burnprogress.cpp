@@ -0,0 +1,58 @@
+#include "burnprogress.h"
+
+#include <QDebug>
+
+#include "ezgraver.h"
+#include "bitmapstats.h"
+
+BurnProgress::BurnProgress()
+        : _mask{QSize{EzGraver::ImageWidth, EzGraver::ImageHeight}, QImage::Format_Mono}, _count{0} {
+    _mask.fill(0);
+}
+
+void BurnProgress::reset() {
+    _mask.fill(0);
+    _count = 0;
+}
+
+void BurnProgress::mark(int x, int y) {
+    if(!_mask.valid(x, y)) {
+        return;
+    }
+
+    auto& byte = _mask.scanLine(y)[x >> 3];
+    uchar const bit = 0x80 >> (x & 7);
+    if(!(byte & bit)) {
+        byte |= bit;
+        ++_count;
+    }
+}
+
+int BurnProgress::count() const {
+    return _count;
+}
+
+QImage BurnProgress::mask() const {
+    return _mask;
+}
+
+QImage BurnProgress::residual(QImage const& bitmap) const {
+    if(bitmap.format() != QImage::Format_Mono || bitmap.size() != _mask.size()) {
+        qDebug() << "cannot compute the residual of bitmap with size" << bitmap.size();
+        return QImage{};
+    }
+
+    // Reports use the coordinates of the preview, whereas device bitmaps are mirrored vertically.
+    QImage residual{bitmap};
+    auto const burnBit = BitmapStats::burnBit(bitmap);
+    auto const bytes = (_mask.width() + 7) / 8;
+    auto const height = _mask.height();
+    for(int y{0}; y < height; ++y) {
+        auto burned = _mask.constScanLine(height - 1 - y);
+        auto line = residual.scanLine(y);
+        for(int i{0}; i < bytes; ++i) {
+            line[i] = burnBit ? line[i] & ~burned[i] : line[i] | burned[i];
+        }
+    }
+    return residual;
+}
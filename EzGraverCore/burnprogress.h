@@ -0,0 +1,61 @@
+#ifndef BURNPROGRESS_H
+#define BURNPROGRESS_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+
+/*!
+ * Keeps track of the pixels reported as burned during a job, so an interrupted
+ * job can be resumed by uploading only the pixels not burned yet.
+ */
+class EZGRAVERCORESHARED_EXPORT BurnProgress {
+public:
+    /*!
+     * Creates a new instance without any burned pixels.
+     */
+    BurnProgress();
+
+    /*!
+     * Forgets all burned pixels, e.g. once a new job has been uploaded.
+     */
+    void reset();
+
+    /*!
+     * Marks a pixel as burned. Pixels outside the engraving area are ignored.
+     *
+     * \param x The x coordinate as reported by the engraver.
+     * \param y The y coordinate as reported by the engraver.
+     */
+    void mark(int x, int y);
+
+    /*!
+     * Gets the number of distinct pixels burned.
+     *
+     * \return The number of burned pixels.
+     */
+    int count() const;
+
+    /*!
+     * Gets the burned pixels in the coordinates reported by the engraver.
+     *
+     * \return A monochrome mask with set bits for burned pixels.
+     */
+    QImage mask() const;
+
+    /*!
+     * Computes the part of the given device ready \a bitmap which has not been burned yet,
+     * i.e. the bitmap AND NOT the burned pixels, row by row on the raw bits.
+     *
+     * \param bitmap The bitmap of the job as produced by \a EzGraver::convertImage.
+     * \return A device ready bitmap with the remaining pixels only, or a null image
+     *         if \a bitmap is no monochrome bitmap of the engraving area.
+     */
+    QImage residual(QImage const& bitmap) const;
+
+private:
+    QImage _mask;
+    int _count;
+};
+
+#endif // BURNPROGRESS_H
@@ -0,0 +1,69 @@
+#include "burnsimulator.h"
+
+#include <array>
+#include <cmath>
+
+#include "edgedetector.h"
+#include "parallel.h"
+
+namespace {
+
+MaterialProfile profile(QString const& name, QRgb surface, QRgb burned, double spotSigma, double bleed, double saturationTime) {
+    MaterialProfile material{};
+    material.name = name;
+    material.surface = surface;
+    material.burned = burned;
+    material.spotSigma = spotSigma;
+    material.bleed = bleed;
+    material.saturationTime = saturationTime;
+    return material;
+}
+
+int mix(int from, int to, double amount) {
+    return qRound(from + (to - from) * amount);
+}
+
+}
+
+QVector<MaterialProfile> MaterialProfile::defaults() {
+    return QVector<MaterialProfile>{
+        profile("Plywood", qRgb(222, 190, 140), qRgb(45, 25, 10), 0.6, 1.2, 60),
+        profile("Cardboard", qRgb(196, 160, 110), qRgb(30, 20, 10), 0.7, 1.6, 40),
+        profile("Paper", qRgb(245, 245, 240), qRgb(60, 40, 20), 0.8, 2.0, 25),
+        profile("Leather", qRgb(150, 95, 60), qRgb(35, 20, 12), 0.5, 0.8, 80)
+    };
+}
+
+double BurnSimulator::spread(MaterialProfile const& material, int burnTime) {
+    return material.spotSigma + material.bleed * qBound(0, burnTime, static_cast<int>(MaxBurnTime)) / MaxBurnTime;
+}
+
+QImage BurnSimulator::simulate(QImage const& raster, MaterialProfile const& material, int burnTime) {
+    // Black pixels turn into 0, blurring spreads the energy of every burned pixel to its neighbors.
+    auto energy = raster.convertToFormat(QImage::Format_Grayscale8);
+    EdgeDetector::gaussianBlur(energy, spread(material, burnTime));
+
+    // The darkness saturates with the deposited energy.
+    std::array<QRgb, 256> response{};
+    auto const exposure = burnTime / material.saturationTime;
+    for(int gray{0}; gray < 256; ++gray) {
+        auto const deposited = (255 - gray) / 255.0;
+        auto const darkness = 1 - std::exp(-deposited * exposure);
+        response[gray] = qRgb(mix(qRed(material.surface), qRed(material.burned), darkness),
+                              mix(qGreen(material.surface), qGreen(material.burned), darkness),
+                              mix(qBlue(material.surface), qBlue(material.burned), darkness));
+    }
+
+    QImage simulated{energy.size(), QImage::Format_RGB32};
+    auto const width = energy.width();
+    Parallel::forEachBand(energy.height(), [&](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto in = energy.constScanLine(y);
+            auto out = reinterpret_cast<QRgb*>(simulated.scanLine(y));
+            for(int x{0}; x < width; ++x) {
+                out[x] = response[in[x]];
+            }
+        }
+    });
+    return simulated;
+}
@@ -0,0 +1,71 @@
+#ifndef BURNSIMULATOR_H
+#define BURNSIMULATOR_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+/*!
+ * Describes how a material reacts to the laser.
+ */
+struct EZGRAVERCORESHARED_EXPORT MaterialProfile {
+    /*! The name shown to the user. */
+    QString name;
+
+    /*! The color of the untouched surface. */
+    QRgb surface;
+
+    /*! The color of the surface burned completely. */
+    QRgb burned;
+
+    /*! The standard deviation of the laser spot in pixels. */
+    double spotSigma;
+
+    /*! The growth of the standard deviation in pixels at the longest burn time, caused by heat bleeding into neighbors. */
+    double bleed;
+
+    /*! The burn time at which a single pixel reaches about 63% of its full darkness. */
+    double saturationTime;
+
+    /*!
+     * Gets the profiles of common materials.
+     *
+     * \return The predefined profiles.
+     */
+    static QVector<MaterialProfile> defaults();
+};
+
+/*!
+ * Renders the expected appearance of an engraved raster. Every burned pixel deposits
+ * energy spread by the laser spot, modeled as a gaussian widening with the burn time.
+ * The deposited energy is mapped to the darkness of the material using a saturating
+ * response curve. The spread uses the separable fixed point blur of the edge detector,
+ * the response curve is a lookup table, so the simulation keeps up with live changes.
+ */
+struct EZGRAVERCORESHARED_EXPORT BurnSimulator {
+    /*! The longest burn time supported by the engraver. */
+    static int const MaxBurnTime{0xF0};
+
+    /*!
+     * Simulates engraving the given \a raster.
+     *
+     * \param raster The raster with black pixels to be burned.
+     * \param material The material engraved.
+     * \param burnTime The burn time per pixel.
+     * \return The expected appearance as RGB image of the size of \a raster.
+     */
+    static QImage simulate(QImage const& raster, MaterialProfile const& material, int burnTime);
+
+    /*!
+     * Gets the standard deviation of the spread of a burned pixel.
+     *
+     * \param material The material engraved.
+     * \param burnTime The burn time per pixel.
+     * \return The standard deviation in pixels.
+     */
+    static double spread(MaterialProfile const& material, int burnTime);
+};
+
+#endif // BURNSIMULATOR_H
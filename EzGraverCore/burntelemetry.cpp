@@ -0,0 +1,187 @@
+#include "burntelemetry.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+
+#include "ezgraver.h"
+
+void BurnTelemetry::start(int burnTime) {
+    _samples.clear();
+    _start = Report::now();
+    _started = QDateTime::currentDateTime();
+    _burnTime = burnTime;
+}
+
+void BurnTelemetry::record(QList<Report> const& reports) {
+    for(auto const& report : reports) {
+        record(report);
+    }
+}
+
+void BurnTelemetry::record(Report const& report) {
+    if(report.type != Report::BurnedPixel) {
+        return;
+    }
+    _samples.append(Sample{static_cast<quint32>(std::max<qint64>(0, report.time - _start)),
+                           static_cast<quint16>(report.x), static_cast<quint16>(report.y)});
+}
+
+QVector<BurnTelemetry::Sample> const& BurnTelemetry::samples() const {
+    return _samples;
+}
+
+int BurnTelemetry::burnTime() const {
+    return _burnTime;
+}
+
+QDateTime BurnTelemetry::started() const {
+    return _started;
+}
+
+qint64 BurnTelemetry::elapsed() const {
+    return Report::now() - _start;
+}
+
+double BurnTelemetry::burnRate() const {
+    if(_samples.size() < 2) {
+        return 0.0;
+    }
+    auto const duration = _samples.last().time - _samples.first().time;
+    return duration > 0 ? (_samples.size() - 1) * 1000.0 / duration : 0.0;
+}
+
+QVector<double> BurnTelemetry::rateSeries(int bucketMs) const {
+    if(_samples.isEmpty() || bucketMs <= 0) {
+        return QVector<double>{};
+    }
+
+    QVector<double> rates(static_cast<int>(_samples.last().time / bucketMs) + 1, 0.0);
+    for(auto const& sample : _samples) {
+        rates[sample.time / bucketMs] += 1000.0 / bucketMs;
+    }
+    return rates;
+}
+
+QVector<qint64> BurnTelemetry::rowDwell() const {
+    QVector<qint64> dwell(EzGraver::ImageHeight, 0);
+    for(int i{0}; i < _samples.size(); ++i) {
+        if(_samples[i].y < dwell.size()) {
+            dwell[_samples[i].y] += _gap(i);
+        }
+    }
+    return dwell;
+}
+
+QVector<qint64> BurnTelemetry::dwellMap(int cellSize) const {
+    auto const columns = (EzGraver::ImageWidth + cellSize - 1) / cellSize;
+    auto const rows = (EzGraver::ImageHeight + cellSize - 1) / cellSize;
+    QVector<qint64> dwell(columns * rows, 0);
+    for(int i{0}; i < _samples.size(); ++i) {
+        auto const& sample = _samples[i];
+        if(sample.x < EzGraver::ImageWidth && sample.y < EzGraver::ImageHeight) {
+            dwell[(sample.y / cellSize) * columns + sample.x / cellSize] += _gap(i);
+        }
+    }
+    return dwell;
+}
+
+BurnTelemetry::GapStats BurnTelemetry::gaps() const {
+    if(_samples.size() < 2) {
+        return GapStats{0.0, 0, 0};
+    }
+
+    QVector<qint64> gaps{};
+    gaps.reserve(_samples.size() - 1);
+    for(int i{1}; i < _samples.size(); ++i) {
+        gaps.append(_gap(i));
+    }
+    auto const max = *std::max_element(gaps.begin(), gaps.end());
+    auto const mean = static_cast<double>(_samples.last().time - _samples.first().time) / gaps.size();
+    std::nth_element(gaps.begin(), gaps.begin() + gaps.size() / 2, gaps.end());
+    return GapStats{mean, gaps[gaps.size() / 2], max};
+}
+
+qint64 BurnTelemetry::stallThreshold() const {
+    auto const threshold = gaps().median * StallFactor;
+    return threshold > MinimumStallMs ? threshold : MinimumStallMs;
+}
+
+QVector<BurnTelemetry::Stall> BurnTelemetry::stalls() const {
+    auto const threshold = stallThreshold();
+    QVector<Stall> stalls{};
+    for(int i{1}; i < _samples.size(); ++i) {
+        auto const gap = _gap(i);
+        if(gap > threshold) {
+            stalls.append(Stall{_samples[i - 1].time, gap, _samples[i].x, _samples[i].y});
+        }
+    }
+    return stalls;
+}
+
+QByteArray BurnTelemetry::toCsv() const {
+    QByteArray csv{"time_ms,x,y,gap_ms\n"};
+    for(int i{0}; i < _samples.size(); ++i) {
+        auto const& sample = _samples[i];
+        csv += QString{"%1,%2,%3,%4\n"}.arg(sample.time).arg(sample.x).arg(sample.y).arg(_gap(i)).toLatin1();
+    }
+    return csv;
+}
+
+QJsonObject BurnTelemetry::toJson() const {
+    auto const gapStats = gaps();
+
+    QJsonArray stallArray{};
+    for(auto const& stall : stalls()) {
+        stallArray.append(QJsonObject{
+            {"start", static_cast<double>(stall.start)},
+            {"duration", static_cast<double>(stall.duration)},
+            {"x", stall.x},
+            {"y", stall.y}
+        });
+    }
+
+    QJsonArray dwellArray{};
+    for(auto const dwell : rowDwell()) {
+        dwellArray.append(static_cast<double>(dwell));
+    }
+
+    QJsonArray sampleArray{};
+    for(auto const& sample : _samples) {
+        sampleArray.append(QJsonArray{static_cast<double>(sample.time), sample.x, sample.y});
+    }
+
+    return QJsonObject{
+        {"started", _started.toString(Qt::ISODate)},
+        {"burnTime", _burnTime},
+        {"burned", _samples.size()},
+        {"burnRate", burnRate()},
+        {"gaps", QJsonObject{
+            {"mean", gapStats.mean},
+            {"median", static_cast<double>(gapStats.median)},
+            {"max", static_cast<double>(gapStats.max)}
+        }},
+        {"stallThreshold", static_cast<double>(stallThreshold())},
+        {"stalls", stallArray},
+        {"rowDwell", dwellArray},
+        {"samples", sampleArray}
+    };
+}
+
+bool BurnTelemetry::save(QString const& fileName) const {
+    QSaveFile file{fileName};
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    auto const json = QFileInfo{fileName}.suffix().toLower() == "json";
+    file.write(json ? QJsonDocument{toJson()}.toJson() : toCsv());
+    return file.commit();
+}
+
+qint64 BurnTelemetry::_gap(int i) const {
+    return i == 0 ? _samples[0].time : _samples[i].time - _samples[i - 1].time;
+}
@@ -0,0 +1,155 @@
+#ifndef BURNTELEMETRY_H
+#define BURNTELEMETRY_H
+
+#include "ezgravercore_global.h"
+
+#include <QVector>
+#include <QList>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QDateTime>
+
+#include "report.h"
+
+/*!
+ * Records the burned pixel reports of a job with the time they have been received at
+ * and analyzes the actual throughput of the engraver.
+ */
+class EZGRAVERCORESHARED_EXPORT BurnTelemetry {
+public:
+    /*!
+     * A single burned pixel of the log, stored compactly in 8 bytes.
+     */
+    struct Sample {
+        /*! The milliseconds since the start of the job. */
+        quint32 time;
+        /*! The x coordinate of the burned pixel. */
+        quint16 x;
+        /*! The y coordinate of the burned pixel. */
+        quint16 y;
+    };
+
+    /*!
+     * A gap between two reports being considerably longer than usual.
+     */
+    struct Stall {
+        /*! The milliseconds since the start of the job the stall has begun at. */
+        qint64 start;
+        /*! The duration of the stall in milliseconds. */
+        qint64 duration;
+        /*! The x coordinate of the pixel reported after the stall. */
+        int x;
+        /*! The y coordinate of the pixel reported after the stall. */
+        int y;
+    };
+
+    /*!
+     * The statistics of the gaps between consecutive reports.
+     */
+    struct GapStats {
+        /*! The mean gap in milliseconds. */
+        double mean;
+        /*! The median gap in milliseconds. */
+        qint64 median;
+        /*! The longest gap in milliseconds. */
+        qint64 max;
+    };
+
+    /*! The minimal gap in milliseconds regarded as a stall. */
+    static qint64 const MinimumStallMs{500};
+
+    /*! Gaps exceeding the median gap by this factor are regarded as stalls. */
+    static int const StallFactor{10};
+
+    /*!
+     * Clears the log and starts recording a new job.
+     *
+     * \param burnTime The burn time of the job.
+     */
+    void start(int burnTime=0);
+
+    /*!
+     * Records the burned pixels among the given \a reports.
+     *
+     * \param reports The reports received from the engraver.
+     */
+    void record(QList<Report> const& reports);
+
+    /*!
+     * Records the given \a report if it is a burned pixel.
+     *
+     * \param report The report received from the engraver.
+     */
+    void record(Report const& report);
+
+    /*! \return The recorded samples in the order they have been received. */
+    QVector<Sample> const& samples() const;
+
+    /*! \return The burn time of the job. */
+    int burnTime() const;
+
+    /*! \return The time the job has been started at. */
+    QDateTime started() const;
+
+    /*! \return The milliseconds elapsed since the job has been started. */
+    qint64 elapsed() const;
+
+    /*! \return The mean burn rate in pixels per second, \c 0 if unknown. */
+    double burnRate() const;
+
+    /*!
+     * Gets the burn rate over time.
+     *
+     * \param bucketMs The duration each value covers in milliseconds.
+     * \return The burn rate in pixels per second of each bucket since the start of the job.
+     */
+    QVector<double> rateSeries(int bucketMs) const;
+
+    /*!
+     * Gets the time spent per row, i.e. the sum of the gaps before the pixels of each row.
+     *
+     * \return The dwell in milliseconds of every row of the engraving area.
+     */
+    QVector<qint64> rowDwell() const;
+
+    /*!
+     * Gets the time spent per area of the engraving area.
+     *
+     * \param cellSize The edge length of each area in pixels.
+     * \return The dwell in milliseconds of each area, row by row.
+     */
+    QVector<qint64> dwellMap(int cellSize) const;
+
+    /*! \return The statistics of the gaps between reports. */
+    GapStats gaps() const;
+
+    /*! \return The gap in milliseconds above which a gap is regarded as a stall. */
+    qint64 stallThreshold() const;
+
+    /*! \return All gaps exceeding \a stallThreshold. */
+    QVector<Stall> stalls() const;
+
+    /*! \return The log as CSV with one line per burned pixel. */
+    QByteArray toCsv() const;
+
+    /*! \return The log and its analysis as JSON. */
+    QJsonObject toJson() const;
+
+    /*!
+     * Exports the log to the given file, as JSON if its suffix is \c json, otherwise as CSV.
+     *
+     * \param fileName The file to write.
+     * \return \c true if the file has been written.
+     */
+    bool save(QString const& fileName) const;
+
+private:
+    QVector<Sample> _samples;
+    qint64 _start{0};
+    QDateTime _started;
+    int _burnTime{0};
+
+    qint64 _gap(int i) const;
+};
+
+#endif // BURNTELEMETRY_H
@@ -0,0 +1,93 @@
+#include "comparison.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+
+#include "bitmapstats.h"
+#include "ezgraver.h"
+#include "tone.h"
+
+namespace {
+
+/*! The stabilizing constants of the structural similarity for 8-bit images. */
+double const C1{(0.01 * 255) * (0.01 * 255)};
+double const C2{(0.03 * 255) * (0.03 * 255)};
+
+Candidate candidate(QString const& name, BinarizerSettings::Mode mode, Qt::ImageConversionFlags flags,
+                    EdgeSettings const& edges, ThresholdSettings const& threshold, int brightness=0) {
+    BinarizerSettings settings{};
+    settings.mode = mode;
+    settings.flags = flags;
+    settings.edges = edges;
+    settings.threshold = threshold;
+    return Candidate{name, settings, brightness, QImage{}, 0.0, 0};
+}
+
+}
+
+QVector<Candidate> Comparison::defaultCandidates(EdgeSettings const& edges, ThresholdSettings const& threshold) {
+    return QVector<Candidate>{
+        candidate("DiffuseDither", BinarizerSettings::Dither, Qt::DiffuseDither, edges, threshold),
+        candidate("OrderedDither", BinarizerSettings::Dither, Qt::OrderedDither, edges, threshold),
+        candidate("ThresholdDither", BinarizerSettings::Dither, Qt::ThresholdDither, edges, threshold),
+        candidate("ThresholdDither (darker)", BinarizerSettings::Dither, Qt::ThresholdDither, edges, threshold, -ThresholdStep),
+        candidate("ThresholdDither (lighter)", BinarizerSettings::Dither, Qt::ThresholdDither, edges, threshold, ThresholdStep),
+        candidate("Edges", BinarizerSettings::Edges, Qt::ThresholdDither, edges, threshold),
+        candidate("Adaptive", BinarizerSettings::Adaptive, Qt::ThresholdDither, edges, threshold)
+    };
+}
+
+void Comparison::evaluate(QImage const& image, QVector<Candidate>& candidates) {
+    auto const reference = Tone::grayscale(image, ToneSettings{});
+    QtConcurrent::blockingMap(candidates, [&reference](Candidate& candidate) {
+        ToneSettings tone{};
+        tone.brightness = candidate.brightness;
+        auto const source = candidate.brightness == 0 ? reference : Tone::apply(reference, tone);
+
+        candidate.raster = Binarizer::apply(source, candidate.settings);
+        candidate.similarity = similarity(reference, candidate.raster);
+        candidate.burnCount = BitmapStats::analyze(EzGraver::convertImage(candidate.raster)).burnCount;
+    });
+}
+
+double Comparison::similarity(QImage const& reference, QImage const& raster) {
+    auto x = reference.convertToFormat(QImage::Format_Grayscale8);
+    auto y = raster.convertToFormat(QImage::Format_Grayscale8);
+    Tone::blur(x, ViewingRadius);
+    Tone::blur(y, ViewingRadius);
+
+    auto const columns = x.width() / WindowSize;
+    auto const rows = x.height() / WindowSize;
+    if(columns == 0 || rows == 0 || x.size() != y.size()) {
+        return 0.0;
+    }
+
+    double total{0};
+    auto const n = static_cast<double>(WindowSize * WindowSize);
+    for(int row{0}; row < rows; ++row) {
+        for(int column{0}; column < columns; ++column) {
+            qint64 sumX{0}, sumY{0}, sumXX{0}, sumYY{0}, sumXY{0};
+            for(int i{0}; i < WindowSize; ++i) {
+                auto lineX = x.constScanLine(row * WindowSize + i) + column * WindowSize;
+                auto lineY = y.constScanLine(row * WindowSize + i) + column * WindowSize;
+                for(int j{0}; j < WindowSize; ++j) {
+                    int const a{lineX[j]};
+                    int const b{lineY[j]};
+                    sumX += a;
+                    sumY += b;
+                    sumXX += a * a;
+                    sumYY += b * b;
+                    sumXY += a * b;
+                }
+            }
+
+            auto const meanX = sumX / n;
+            auto const meanY = sumY / n;
+            auto const varianceX = sumXX / n - meanX * meanX;
+            auto const varianceY = sumYY / n - meanY * meanY;
+            auto const covariance = sumXY / n - meanX * meanY;
+            total += ((2 * meanX * meanY + C1) * (2 * covariance + C2))
+                    / ((meanX * meanX + meanY * meanY + C1) * (varianceX + varianceY + C2));
+        }
+    }
+    return total / (rows * columns);
+}
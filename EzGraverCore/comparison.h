@@ -0,0 +1,78 @@
+#ifndef COMPARISON_H
+#define COMPARISON_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+#include "binarizer.h"
+
+/*!
+ * A conversion candidate of the comparison.
+ */
+struct EZGRAVERCORESHARED_EXPORT Candidate {
+    /*! The name shown to the user. */
+    QString name;
+
+    /*! The settings of the conversion. */
+    BinarizerSettings settings;
+
+    /*! The brightness offset applied before the conversion, used to shift the threshold. */
+    int brightness;
+
+    /*! The converted image in the format \c QImage::Format_Mono with black pixels to be burned. */
+    QImage raster;
+
+    /*! The structural similarity of the raster to the source, \c 1 being identical. */
+    double similarity;
+
+    /*! The number of pixels being burned. */
+    int burnCount;
+};
+
+/*!
+ * Renders several conversion candidates of the same image concurrently and scores
+ * them by their perceived quality and their number of burned pixels.
+ */
+struct EZGRAVERCORESHARED_EXPORT Comparison {
+    /*! The blur radius approximating the viewing distance before comparing images. */
+    static int const ViewingRadius{2};
+
+    /*! The size of the windows the structural similarity is computed in. */
+    static int const WindowSize{8};
+
+    /*! The brightness offsets used to vary the threshold of the threshold dithering. */
+    static int const ThresholdStep{40};
+
+    /*!
+     * Gets the default candidates: every dithering mode, the threshold dithering with
+     * several thresholds, the edge detection and the adaptive threshold with the given settings.
+     *
+     * \param edges The settings of the edge detection.
+     * \param threshold The settings of the adaptive threshold.
+     * \return The candidates yet to be evaluated.
+     */
+    static QVector<Candidate> defaultCandidates(EdgeSettings const& edges, ThresholdSettings const& threshold);
+
+    /*!
+     * Converts the given \a image with each candidate in parallel and scores the results.
+     *
+     * \param image The image as it is passed to the binarization.
+     * \param candidates The candidates to evaluate.
+     */
+    static void evaluate(QImage const& image, QVector<Candidate>& candidates);
+
+    /*!
+     * Computes the mean structural similarity (SSIM) of a monochrome \a raster and the
+     * grayscale \a reference after both have been blurred by \a ViewingRadius.
+     *
+     * \param reference The grayscale source.
+     * \param raster The monochrome image of the same size.
+     * \return The similarity in the range -1 to 1.
+     */
+    static double similarity(QImage const& reference, QImage const& raster);
+};
+
+#endif // COMPARISON_H
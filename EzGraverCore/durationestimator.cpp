@@ -0,0 +1,188 @@
+#include "durationestimator.h"
+
+#include <QSettings>
+#include <QVariant>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double dot(DurationEstimator::Vector const& a, DurationEstimator::Vector const& b) {
+    double sum{0};
+    for(int i{0}; i < DurationEstimator::FeatureCount; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/*! Solves the linear system \a a x = \a b by gaussian elimination, returns \c false if it is singular. */
+template<int N>
+bool solve(std::array<std::array<double, N>, N> a, std::array<double, N> b, std::array<double, N>& x) {
+    for(int column{0}; column < N; ++column) {
+        int pivot{column};
+        for(int row{column + 1}; row < N; ++row) {
+            if(std::abs(a[row][column]) > std::abs(a[pivot][column])) {
+                pivot = row;
+            }
+        }
+        if(std::abs(a[pivot][column]) < 1e-12) {
+            return false;
+        }
+        std::swap(a[column], a[pivot]);
+        std::swap(b[column], b[pivot]);
+
+        for(int row{column + 1}; row < N; ++row) {
+            auto const factor = a[row][column] / a[column][column];
+            for(int i{column}; i < N; ++i) {
+                a[row][i] -= factor * a[column][i];
+            }
+            b[row] -= factor * b[column];
+        }
+    }
+
+    for(int row{N - 1}; row >= 0; --row) {
+        auto sum = b[row];
+        for(int i{row + 1}; i < N; ++i) {
+            sum -= a[row][i] * x[i];
+        }
+        x[row] = sum / a[row][row];
+    }
+    return true;
+}
+
+/*! The settings shared by all EzGraver tools. */
+char const* const Organization{"EzGraver"};
+char const* const Application{"EzGraver"};
+
+/*! The settings key of the recorded jobs. */
+char const* const JobsKey{"estimator/jobs"};
+
+}
+
+DurationEstimator::DurationEstimator() : _jobs{}, _coefficients(defaultCoefficients()) {
+    _load();
+    _fit();
+}
+
+DurationEstimator::Vector DurationEstimator::features(BitmapStats const& stats, int burnTime) {
+    return Vector{{
+        static_cast<double>(stats.burnCount) * burnTime,
+        static_cast<double>(stats.burnCount),
+        static_cast<double>(stats.rowCount),
+        static_cast<double>(stats.spanCount),
+        1.0
+    }};
+}
+
+DurationEstimator::Vector DurationEstimator::defaultCoefficients() {
+    // Seconds per burned pixel and burn time unit, per pixel, per row, per span and per job.
+    return Vector{{0.0005, 0.005, 0.02, 0.01, 2.0}};
+}
+
+double DurationEstimator::estimate(BitmapStats const& stats, int burnTime) const {
+    if(stats.burnCount == 0) {
+        return 0.0;
+    }
+    return std::max(0.0, dot(_coefficients, features(stats, burnTime)));
+}
+
+void DurationEstimator::addJob(BitmapStats const& stats, int burnTime, double seconds) {
+    if(stats.burnCount == 0 || seconds <= 0) {
+        return;
+    }
+
+    _jobs.append(Job{features(stats, burnTime), seconds});
+    while(_jobs.size() > MaxJobs) {
+        _jobs.removeFirst();
+    }
+    _fit();
+    _save();
+    qDebug() << "calibrated duration estimate with" << _jobs.size() << "jobs";
+}
+
+int DurationEstimator::jobCount() const {
+    return _jobs.size();
+}
+
+DurationEstimator::Vector DurationEstimator::coefficients() const {
+    return _coefficients;
+}
+
+void DurationEstimator::_load() {
+    QSettings settings{Organization, Application};
+    auto const jobs = settings.value(JobsKey).toList();
+    for(auto const& entry : jobs) {
+        auto const values = entry.toList();
+        if(values.size() != FeatureCount + 1) {
+            continue;
+        }
+
+        Job job{};
+        for(int i{0}; i < FeatureCount; ++i) {
+            job.features[i] = values[i].toDouble();
+        }
+        job.seconds = values[FeatureCount].toDouble();
+        _jobs.append(job);
+    }
+}
+
+void DurationEstimator::_save() const {
+    QVariantList jobs{};
+    for(auto const& job : _jobs) {
+        QVariantList values{};
+        for(auto const feature : job.features) {
+            values.append(feature);
+        }
+        values.append(job.seconds);
+        jobs.append(QVariant{values});
+    }
+    QSettings settings{Organization, Application};
+    settings.setValue(JobsKey, jobs);
+}
+
+void DurationEstimator::_fit() {
+    auto const defaults = defaultCoefficients();
+    if(_jobs.isEmpty()) {
+        _coefficients = defaults;
+        return;
+    }
+
+    // Scale the defaults to match the recorded jobs as a whole.
+    double measured{0}, predicted{0};
+    for(auto const& job : _jobs) {
+        auto const prediction = dot(defaults, job.features);
+        measured += job.seconds * prediction;
+        predicted += prediction * prediction;
+    }
+    auto const scale = predicted > 0 ? measured / predicted : 1.0;
+    Vector prior{};
+    std::transform(defaults.begin(), defaults.end(), prior.begin(), [scale](double c) { return c * scale; });
+    _coefficients = prior;
+    if(_jobs.size() < MinimumFitJobs) {
+        return;
+    }
+
+    // Least squares, regularized towards the scaled defaults relative to each feature's magnitude.
+    std::array<std::array<double, FeatureCount>, FeatureCount> a{};
+    Vector b{};
+    for(auto const& job : _jobs) {
+        for(int i{0}; i < FeatureCount; ++i) {
+            for(int j{0}; j < FeatureCount; ++j) {
+                a[i][j] += job.features[i] * job.features[j];
+            }
+            b[i] += job.features[i] * job.seconds;
+        }
+    }
+    for(int i{0}; i < FeatureCount; ++i) {
+        auto const weight = Shrinkage * std::max(a[i][i], 1e-9);
+        a[i][i] += weight;
+        b[i] += weight * prior[i];
+    }
+
+    Vector fitted{};
+    if(solve<FeatureCount>(a, b, fitted)) {
+        _coefficients = fitted;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef DURATIONESTIMATOR_H
+#define DURATIONESTIMATOR_H
+
+#include "ezgravercore_global.h"
+
+#include <QList>
+
+#include <array>
+
+#include "bitmapstats.h"
+
+/*!
+ * Predicts the duration of the burn phase of a job before it is started. The duration is
+ * modelled linearly on the burned pixels weighted by the burn time, the burned pixels,
+ * the occupied rows and the spans of the bitmap. The coefficients are fitted to the jobs
+ * completed so far, which are persisted in the settings shared by all EzGraver tools.
+ */
+class EZGRAVERCORESHARED_EXPORT DurationEstimator {
+public:
+    /*! The number of features of the model, including the constant. */
+    static int const FeatureCount{5};
+
+    /*! The number of the most recent jobs kept for fitting. */
+    static int const MaxJobs{64};
+
+    /*! The number of jobs required to fit every coefficient, fewer jobs only scale the defaults. */
+    static int const MinimumFitJobs{2 * FeatureCount};
+
+    typedef std::array<double, FeatureCount> Vector;
+
+    /*!
+     * Creates an estimator calibrated by the jobs stored in the settings.
+     */
+    DurationEstimator();
+
+    /*!
+     * Gets the features of a job.
+     *
+     * \param stats The statistics of the bitmap.
+     * \param burnTime The burn time of the job.
+     * \return The features in the order of the coefficients.
+     */
+    static Vector features(BitmapStats const& stats, int burnTime);
+
+    /*!
+     * Gets the coefficients used as long as no job has been recorded. These are rough
+     * guesses which are scaled and refined as soon as jobs are recorded.
+     *
+     * \return The default coefficients.
+     */
+    static Vector defaultCoefficients();
+
+    /*!
+     * Estimates the duration of the burn phase.
+     *
+     * \param stats The statistics of the bitmap.
+     * \param burnTime The burn time of the job.
+     * \return The estimated duration in seconds.
+     */
+    double estimate(BitmapStats const& stats, int burnTime) const;
+
+    /*!
+     * Records a completed job, refits the coefficients and persists the job.
+     *
+     * \param stats The statistics of the engraved bitmap.
+     * \param burnTime The burn time of the job.
+     * \param seconds The measured duration of the burn phase.
+     */
+    void addJob(BitmapStats const& stats, int burnTime, double seconds);
+
+    /*! \return The number of jobs the estimator is calibrated with. */
+    int jobCount() const;
+
+    /*! \return The coefficients currently in use. */
+    Vector coefficients() const;
+
+private:
+    /*! The weight pulling the fitted coefficients towards the scaled defaults. */
+    static constexpr double Shrinkage{0.1};
+
+    struct Job {
+        Vector features;
+        double seconds;
+    };
+
+    QList<Job> _jobs;
+    Vector _coefficients;
+
+    void _load();
+    void _save() const;
+    void _fit();
+};
+
+#endif // DURATIONESTIMATOR_H
@@ -0,0 +1,192 @@
+#include "edgedetector.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "parallel.h"
+#include "tone.h"
+
+namespace {
+
+/*! The fixed point precision of the gaussian kernel weights. */
+int const KernelBits{12};
+
+/*! The sectors a gradient direction is quantized to. */
+enum Direction : uchar { Horizontal, Vertical, Diagonal, AntiDiagonal };
+
+QVector<int> gaussianKernel(double sigma) {
+    auto const radius = std::max(1, static_cast<int>(std::ceil(3 * sigma)));
+    QVector<double> weights(2*radius + 1);
+    double total{0};
+    for(int i{-radius}; i <= radius; ++i) {
+        total += weights[i + radius] = std::exp(-(i*i) / (2 * sigma * sigma));
+    }
+
+    QVector<int> kernel(weights.size());
+    int sum{0};
+    for(int i{0}; i < weights.size(); ++i) {
+        sum += kernel[i] = qRound(weights[i] / total * (1 << KernelBits));
+    }
+    kernel[radius] += (1 << KernelBits) - sum;
+    return kernel;
+}
+
+}
+
+bool EdgeSettings::operator==(EdgeSettings const& other) const {
+    return sigma == other.sigma && lowThreshold == other.lowThreshold && highThreshold == other.highThreshold;
+}
+
+bool EdgeSettings::operator!=(EdgeSettings const& other) const {
+    return !(*this == other);
+}
+
+void EdgeDetector::gaussianBlur(QImage& image, double sigma) {
+    if(sigma <= 0) {
+        return;
+    }
+
+    auto const kernel = gaussianKernel(sigma);
+    auto const radius = kernel.size() / 2;
+    auto const width = image.width();
+    auto const height = image.height();
+    int const rounding{1 << (KernelBits - 1)};
+
+    // Horizontal pass into a temporary image.
+    QImage horizontal{image.size(), QImage::Format_Grayscale8};
+    Parallel::forEachBand(height, [&](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto in = image.constScanLine(y);
+            auto out = horizontal.scanLine(y);
+            for(int x{0}; x < width; ++x) {
+                int sum{rounding};
+                for(int k{-radius}; k <= radius; ++k) {
+                    sum += kernel[k + radius] * in[qBound(0, x + k, width - 1)];
+                }
+                out[x] = static_cast<uchar>(sum >> KernelBits);
+            }
+        }
+    });
+
+    // Vertical pass back into the image, accumulating whole rows keeps the inner loop vectorizable.
+    Parallel::forEachBand(height, [&](int first, int last) {
+        std::vector<int> sum(width);
+        for(int y{first}; y < last; ++y) {
+            std::fill(sum.begin(), sum.end(), rounding);
+            for(int k{-radius}; k <= radius; ++k) {
+                auto const weight = kernel[k + radius];
+                auto in = horizontal.constScanLine(qBound(0, y + k, height - 1));
+                for(int x{0}; x < width; ++x) {
+                    sum[x] += weight * in[x];
+                }
+            }
+            auto out = image.scanLine(y);
+            for(int x{0}; x < width; ++x) {
+                out[x] = static_cast<uchar>(sum[x] >> KernelBits);
+            }
+        }
+    });
+}
+
+QImage EdgeDetector::detect(QImage const& image, EdgeSettings const& settings) {
+    auto gray = image.format() == QImage::Format_Grayscale8 ? image.copy() : Tone::grayscale(image, ToneSettings{});
+    gaussianBlur(gray, settings.sigma);
+
+    auto const width = gray.width();
+    auto const height = gray.height();
+    std::vector<int> magnitude(width * height, 0);
+    std::vector<uchar> direction(width * height, Horizontal);
+
+    // Sobel gradients using the L1 norm, scaled to 0 to 255.
+    Parallel::forEachBand(height, [&](int first, int last) {
+        for(int y{std::max(first, 1)}; y < std::min(last, height - 1); ++y) {
+            auto above = gray.constScanLine(y - 1);
+            auto line = gray.constScanLine(y);
+            auto below = gray.constScanLine(y + 1);
+            for(int x{1}; x < width - 1; ++x) {
+                auto const gx = (above[x+1] + 2*line[x+1] + below[x+1]) - (above[x-1] + 2*line[x-1] + below[x-1]);
+                auto const gy = (below[x-1] + 2*below[x] + below[x+1]) - (above[x-1] + 2*above[x] + above[x+1]);
+                auto const ax = std::abs(gx);
+                auto const ay = std::abs(gy);
+                magnitude[y*width + x] = (ax + ay) >> 3;
+
+                // tan(22.5°) ~ 0.4142 and tan(67.5°) ~ 2.4142 in fixed point.
+                direction[y*width + x] = ay * 1000 <= ax * 414 ? Horizontal
+                        : ay * 1000 >= ax * 2414 ? Vertical
+                        : (gx > 0) == (gy > 0) ? Diagonal : AntiDiagonal;
+            }
+        }
+    });
+
+    // Non-maximum suppression thins the edges to single pixels.
+    std::vector<uchar> state(width * height, 0);
+    int const low{settings.lowThreshold};
+    int const high{std::max(settings.highThreshold, low)};
+    Parallel::forEachBand(height, [&](int first, int last) {
+        for(int y{std::max(first, 1)}; y < std::min(last, height - 1); ++y) {
+            for(int x{1}; x < width - 1; ++x) {
+                auto const i = y*width + x;
+                auto const value = magnitude[i];
+                if(value < low) {
+                    continue;
+                }
+
+                int offset{1};
+                switch(direction[i]) {
+                case Horizontal: offset = 1; break;
+                case Vertical: offset = width; break;
+                case Diagonal: offset = width + 1; break;
+                case AntiDiagonal: offset = width - 1; break;
+                }
+                if(value >= magnitude[i - offset] && value > magnitude[i + offset]) {
+                    state[i] = value >= high ? 2 : 1;
+                }
+            }
+        }
+    });
+
+    // Hysteresis: weak pixels are kept if they are connected to a strong one.
+    std::vector<int> stack{};
+    for(int i{0}; i < width * height; ++i) {
+        if(state[i] == 2) {
+            stack.push_back(i);
+        }
+    }
+    while(!stack.empty()) {
+        auto const i = stack.back();
+        stack.pop_back();
+        auto const x = i % width;
+        auto const y = i / width;
+        for(int dy{-1}; dy <= 1; ++dy) {
+            for(int dx{-1}; dx <= 1; ++dx) {
+                if(x + dx < 0 || x + dx >= width || y + dy < 0 || y + dy >= height) {
+                    continue;
+                }
+                auto const j = i + dy*width + dx;
+                if(state[j] == 1) {
+                    state[j] = 2;
+                    stack.push_back(j);
+                }
+            }
+        }
+    }
+
+    QImage edges{gray.size(), QImage::Format_Mono};
+    edges.setColorTable(QVector<QRgb>{qRgb(255, 255, 255), qRgb(0, 0, 0)});
+    edges.fill(0);
+    Parallel::forEachBand(height, [&](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto line = edges.scanLine(y);
+            for(int x{0}; x < width; ++x) {
+                if(state[y*width + x] == 2) {
+                    line[x >> 3] |= static_cast<uchar>(0x80 >> (x & 7));
+                }
+            }
+        }
+    });
+    return edges;
+}
@@ -0,0 +1,52 @@
+#ifndef EDGEDETECTOR_H
+#define EDGEDETECTOR_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QMetaType>
+
+/*!
+ * The settings of the edge detection.
+ */
+struct EZGRAVERCORESHARED_EXPORT EdgeSettings {
+    /*! The standard deviation of the gaussian blur applied before detecting edges. */
+    double sigma{1.4};
+
+    /*! The gradient magnitude (0 to 255) a pixel needs to continue an edge. */
+    int lowThreshold{20};
+
+    /*! The gradient magnitude (0 to 255) a pixel needs to start an edge. */
+    int highThreshold{50};
+
+    bool operator==(EdgeSettings const& other) const;
+    bool operator!=(EdgeSettings const& other) const;
+};
+
+Q_DECLARE_METATYPE(EdgeSettings)
+
+/*!
+ * Detects the outlines of an image using the Canny algorithm: gaussian blur, Sobel
+ * gradients, non-maximum suppression and hysteresis. The filters are separable and
+ * processed row-wise in parallel bands, which allows the compiler to vectorize them.
+ */
+struct EZGRAVERCORESHARED_EXPORT EdgeDetector {
+    /*!
+     * Detects the edges of the given \a image.
+     *
+     * \param image The image to process, it is converted to grayscale if necessary.
+     * \param settings The settings of the detection.
+     * \return A monochrome image with thin black lines on white ground.
+     */
+    static QImage detect(QImage const& image, EdgeSettings const& settings);
+
+    /*!
+     * Blurs the given grayscale \a image in place using a separable gaussian kernel.
+     *
+     * \param image The image in the format \c QImage::Format_Grayscale8.
+     * \param sigma The standard deviation of the kernel.
+     */
+    static void gaussianBlur(QImage& image, double sigma);
+};
+
+#endif // EDGEDETECTOR_H
@@ -0,0 +1,180 @@
+#include "engravejob.h"
+
+#include <QTimer>
+#include <QMetaEnum>
+#include <QDebug>
+
+#include <algorithm>
+
+#include "durationestimator.h"
+
+EngraveJob::EngraveJob(std::shared_ptr<EzGraver> const& engraver, QImage const& bitmap, int burnTime, QObject* parent)
+        : QObject{parent}, _engraver{engraver}, _bitmap{bitmap}, _mappedBitmap{}, _burnTime{burnTime}, _state{Idle},
+          _stats(BitmapStats::analyze(bitmap)), _burnedCount{0}, _bytesSent{0}, _bytesTotal{0},
+          _clock{}, _burnClock{}, _burnPhaseClock{} {}
+
+EngraveJob::EngraveJob(std::shared_ptr<EzGraver> const& engraver, std::shared_ptr<MappedBitmap> const& bitmap, int burnTime, QObject* parent)
+        : QObject{parent}, _engraver{engraver}, _bitmap{}, _mappedBitmap{bitmap}, _burnTime{burnTime}, _state{Idle},
+          _stats(bitmap->stats()), _burnedCount{0}, _bytesSent{0}, _bytesTotal{0},
+          _clock{}, _burnClock{}, _burnPhaseClock{} {}
+
+EngraveJob::~EngraveJob() {}
+
+EngraveJob::State EngraveJob::state() const {
+    return _state;
+}
+
+QString EngraveJob::stateName(State state) {
+    return QString{QMetaEnum::fromType<State>().valueToKey(state)}.toLower();
+}
+
+int EngraveJob::burnCount() const {
+    return _stats.burnCount;
+}
+
+int EngraveJob::burnedCount() const {
+    return _burnedCount;
+}
+
+qint64 EngraveJob::bytesSent() const {
+    return _bytesSent;
+}
+
+qint64 EngraveJob::bytesTotal() const {
+    return _bytesTotal;
+}
+
+double EngraveJob::burnRate() const {
+    if(!_burnClock.isValid() || _burnedCount == 0) {
+        return 0;
+    }
+    auto elapsed = _burnClock.elapsed();
+    return elapsed > 0 ? _burnedCount * 1000.0 / elapsed : 0;
+}
+
+double EngraveJob::remainingTime() const {
+    auto rate = burnRate();
+    if(rate <= 0) {
+        return -1;
+    }
+    return std::max(0, _stats.burnCount - _burnedCount) / rate;
+}
+
+double EngraveJob::estimatedTime() const {
+    return DurationEstimator{}.estimate(_stats, _burnTime);
+}
+
+qint64 EngraveJob::elapsed() const {
+    return _clock.isValid() ? _clock.elapsed() : 0;
+}
+
+void EngraveJob::start() {
+    if(_state != Idle) {
+        return;
+    }
+
+    auto serial = _engraver->serialPort().get();
+    connect(serial, &QSerialPort::readyRead, this, &EngraveJob::_readyRead);
+    connect(serial, static_cast<void(QSerialPort::*)(QSerialPort::SerialPortError)>(&QSerialPort::error),
+            this, &EngraveJob::_serialError);
+
+    _clock.start();
+    _setState(Erasing);
+    _engraver->erase();
+    QTimer::singleShot(EzGraver::EraseTimeMs, this, &EngraveJob::_upload);
+}
+
+void EngraveJob::cancel() {
+    switch(_state) {
+    case Idle:
+    case Erasing:
+        _finish(Cancelled);
+        break;
+    case Uploading:
+    case AwaitingReady:
+    case Burning:
+        // The reset discards the rest of a running upload before it returns, so no
+        // byte of the bitmap is sent once the job has been reported as cancelled.
+        _engraver->reset();
+        _finish(Cancelled);
+        break;
+    default:
+        break;
+    }
+}
+
+void EngraveJob::_setState(State state) {
+    qDebug() << "job state changed to" << stateName(state);
+    _state = state;
+    emit stateChanged(state);
+}
+
+void EngraveJob::_finish(State state) {
+    disconnect(_engraver->serialPort().get(), 0, this, 0);
+    _setState(state);
+    emit finished(state == Completed);
+}
+
+void EngraveJob::_upload() {
+    if(_state != Erasing) {
+        return;
+    }
+
+    _setState(Uploading);
+    connect(_engraver->serialPort().get(), &QSerialPort::bytesWritten, this, &EngraveJob::_bytesWritten);
+    _bytesTotal = _mappedBitmap ? _engraver->uploadBitmap(_mappedBitmap) : _engraver->uploadBitmap(_bitmap);
+}
+
+void EngraveJob::_bytesWritten(qint64 bytes) {
+    if(_state != Uploading) {
+        return;
+    }
+
+    _bytesSent = std::min(_bytesTotal, _bytesSent + bytes);
+    emit uploadProgressed(_bytesSent, _bytesTotal);
+    if(_bytesSent >= _bytesTotal) {
+        _setState(AwaitingReady);
+        _engraver->requestReady();
+    }
+}
+
+void EngraveJob::_readyRead() {
+    for(auto const& report : _engraver->readReports()) {
+        switch(report.type) {
+        case Report::Ready:
+            if(_state == AwaitingReady) {
+                _setState(Burning);
+                _burnPhaseClock.start();
+                _engraver->start(static_cast<unsigned char>(_burnTime));
+            }
+            break;
+        case Report::BurnedPixel:
+            if(_state == Burning) {
+                if(!_burnClock.isValid()) {
+                    _burnClock.start();
+                }
+                ++_burnedCount;
+                emit pixelBurned(report.x, report.y);
+            }
+            break;
+        case Report::Complete:
+            if(_state == Burning) {
+                DurationEstimator{}.addJob(_stats, _burnTime, _burnPhaseClock.elapsed() / 1000.0);
+                _finish(Completed);
+                return;
+            }
+            break;
+        }
+    }
+}
+
+void EngraveJob::_serialError(QSerialPort::SerialPortError error) {
+    if(error == QSerialPort::NoError || _state == Completed || _state == Cancelled || _state == Failed) {
+        return;
+    }
+
+    qDebug() << "serial port error during job:" << _engraver->serialPort()->errorString();
+    if(error == QSerialPort::ResourceError || error == QSerialPort::WriteError || error == QSerialPort::ReadError) {
+        _finish(Failed);
+    }
+}
@@ -0,0 +1,198 @@
+#ifndef ENGRAVEJOB_H
+#define ENGRAVEJOB_H
+
+#include "ezgravercore_global.h"
+
+#include <QObject>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QSerialPort>
+
+#include <memory>
+
+#include "ezgraver.h"
+#include "bitmapstats.h"
+
+/*!
+ * Runs a complete engraving job on an engraver: the EEPROM is erased, the bitmap
+ * is uploaded and the engraving process is started and followed until the engraver
+ * reports its completion. The job has to be driven by an event loop.
+ */
+class EZGRAVERCORESHARED_EXPORT EngraveJob : public QObject {
+    Q_OBJECT
+
+public:
+    /*! The states a job passes through. */
+    enum State {
+        Idle,
+        Erasing,
+        Uploading,
+        AwaitingReady,
+        Burning,
+        Completed,
+        Cancelled,
+        Failed
+    };
+    Q_ENUM(State)
+
+    /*!
+     * Creates a new job engraving the given \a bitmap using \a engraver.
+     *
+     * \param engraver The engraver to use.
+     * \param bitmap The device ready bitmap as returned by \a EzGraver::convertImage.
+     * \param burnTime The burn time to use in milliseconds.
+     * \param parent The parent of the job.
+     */
+    explicit EngraveJob(std::shared_ptr<EzGraver> const& engraver, QImage const& bitmap, int burnTime, QObject* parent=NULL);
+
+    /*!
+     * Creates a new job uploading the given mapped monochrome \a bitmap using \a engraver.
+     *
+     * \param engraver The engraver to use.
+     * \param bitmap The mapped monochrome image.
+     * \param burnTime The burn time to use in milliseconds.
+     * \param parent The parent of the job.
+     */
+    explicit EngraveJob(std::shared_ptr<EzGraver> const& engraver, std::shared_ptr<MappedBitmap> const& bitmap, int burnTime, QObject* parent=NULL);
+
+    /*!
+     * Frees all required resources upon deconstruction.
+     */
+    virtual ~EngraveJob();
+
+    /*!
+     * Gets the current state of the job.
+     *
+     * \return The current state.
+     */
+    State state() const;
+
+    /*!
+     * Gets the name of the given \a state.
+     *
+     * \param state The state to get the name of.
+     * \return The name of the state.
+     */
+    static QString stateName(State state);
+
+    /*!
+     * Gets the number of pixels to burn.
+     *
+     * \return The number of pixels to burn.
+     */
+    int burnCount() const;
+
+    /*!
+     * Gets the number of pixels reported as burned.
+     *
+     * \return The number of burned pixels.
+     */
+    int burnedCount() const;
+
+    /*!
+     * Gets the number of image bytes handed over to the engraver.
+     *
+     * \return The number of bytes sent.
+     */
+    qint64 bytesSent() const;
+
+    /*!
+     * Gets the total number of image bytes to upload.
+     *
+     * \return The number of bytes to upload.
+     */
+    qint64 bytesTotal() const;
+
+    /*!
+     * Gets the burn rate measured since the first pixel has been reported.
+     *
+     * \return The burn rate in pixels per second or \c 0 if unknown.
+     */
+    double burnRate() const;
+
+    /*!
+     * Gets the estimated time left until the engraving process completes.
+     *
+     * \return The remaining time in seconds or \c -1 if unknown.
+     */
+    double remainingTime() const;
+
+    /*!
+     * Gets the duration of the burn phase predicted before the job is started.
+     * Every completed job calibrates the predictions of the following ones.
+     *
+     * \return The estimated duration in seconds.
+     */
+    double estimatedTime() const;
+
+    /*!
+     * Gets the time passed since the job has been started.
+     *
+     * \return The elapsed time in milliseconds.
+     */
+    qint64 elapsed() const;
+
+public slots:
+    /*! Starts the job by erasing the EEPROM. */
+    void start();
+
+    /*!
+     * Cancels the job. If the engraver already received data, it is reset and the
+     * remaining part of a running upload is discarded.
+     */
+    void cancel();
+
+signals:
+    /*!
+     * Fired as soon as the job entered another state.
+     *
+     * \param state The new state.
+     */
+    void stateChanged(EngraveJob::State state);
+
+    /*!
+     * Fired whenever image bytes have been handed over to the engraver.
+     *
+     * \param bytesSent The number of bytes sent so far.
+     * \param bytesTotal The number of bytes to send.
+     */
+    void uploadProgressed(qint64 bytesSent, qint64 bytesTotal);
+
+    /*!
+     * Fired as soon as the engraver reported a burned pixel.
+     *
+     * \param x The x coordinate of the pixel.
+     * \param y The y coordinate of the pixel.
+     */
+    void pixelBurned(int x, int y);
+
+    /*!
+     * Fired as soon as the job reached a final state.
+     *
+     * \param success \c true if the engraving process has been completed.
+     */
+    void finished(bool success);
+
+private:
+    std::shared_ptr<EzGraver> _engraver;
+    QImage _bitmap;
+    std::shared_ptr<MappedBitmap> _mappedBitmap;
+    int _burnTime;
+    State _state;
+    BitmapStats _stats;
+    int _burnedCount;
+    qint64 _bytesSent;
+    qint64 _bytesTotal;
+    QElapsedTimer _clock;
+    QElapsedTimer _burnClock;
+    QElapsedTimer _burnPhaseClock;
+
+    void _setState(State state);
+    void _finish(State state);
+    void _upload();
+    void _bytesWritten(qint64 bytes);
+    void _readyRead();
+    void _serialError(QSerialPort::SerialPortError error);
+};
+
+#endif // ENGRAVEJOB_H
@@ -5,13 +5,90 @@
 #include <QDebug>
 #include <QBitmap>
 #include <QBuffer>
+#include <QEvent>
+#include <QCoreApplication>
+#include <QSemaphore>
 
 #include <iterator>
 #include <algorithm>
 #include <functional>
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef Q_OS_LINUX
+#include <sys/ioctl.h>
+#include <termios.h>
+#endif
+
+namespace {
+
+/*! The command code preceding the direction of every single step. */
+char const StepCommand{'\xF5'};
+
+/*! An event carrying a function to invoke on the receiver's thread. */
+class CallEvent : public QEvent {
+public:
+    explicit CallEvent(std::function<void()> const& function) : QEvent{QEvent::User}, function{function} {}
+    std::function<void()> function;
+};
+
+/*! Invokes the functions of all posted call events in the order they have been posted. */
+class Dispatcher : public QObject {
+public:
+    explicit Dispatcher(QObject* parent) : QObject{parent} {}
+
+protected:
+    bool event(QEvent* event) {
+        if(event->type() == QEvent::User) {
+            static_cast<CallEvent*>(event)->function();
+            return true;
+        }
+        return QObject::event(event);
+    }
+};
+
+/*! Invokes \a function on the thread of \a dispatcher and optionally awaits its completion. */
+void callOn(QObject* dispatcher, std::function<void()> const& function, bool blocking) {
+    if(dispatcher->thread() == QThread::currentThread()) {
+        function();
+        return;
+    }
+    if(!blocking) {
+        QCoreApplication::postEvent(dispatcher, new CallEvent{function});
+        return;
+    }
 
+    QSemaphore done{};
+    QCoreApplication::postEvent(dispatcher, new CallEvent{[&function, &done] {
+        function();
+        done.release();
+    }});
+    done.acquire();
+}
 
-EzGraver::EzGraver(std::shared_ptr<QSerialPort> serial) : _serial{serial} {}
+}
+
+
+EzGraver::EzGraver(std::shared_ptr<QSerialPort> serial, std::unique_ptr<QThread> ioThread, QObject* dispatcher)
+        : _serial{serial}, _ioThread{std::move(ioThread)}, _dispatcher{dispatcher}, _pumpTimer{new QTimer},
+          _moveTimer{new QTimer}, _moves{}, _pendingSteps{0}, _rateClock{}, _pending{}, _pendingOffset{0}, _handedOver{0}, _drainedMark{0}, _sampleMark{0},
+          _throughput{0}, _pumping{false}, _reportParser{}, _reports{}, _overflow{}, _overflowed{false} {
+    _pumpTimer->setInterval(ChunkIntervalMs / 2);
+    _pumpTimer->moveToThread(_serial->thread());
+    QObject::connect(_pumpTimer.get(), &QTimer::timeout, [this] { _pump(); });
+    _moveTimer->setInterval(MoveIntervalMs);
+    _moveTimer->moveToThread(_serial->thread());
+    QObject::connect(_moveTimer.get(), &QTimer::timeout, [this] { _pumpMoves(); });
+    _bytesWrittenConnection = QObject::connect(_serial.get(), &QSerialPort::bytesWritten, [this](qint64 bytes) {
+        if(!_pending.isEmpty()) {
+            _handedOver += bytes;
+            _pump();
+        }
+    });
+    if(_ioThread) {
+        _readyReadConnection = QObject::connect(_serial.get(), &QSerialPort::readyRead, [this] { _enqueueReports(); });
+    }
+}
 
 void EzGraver::start(unsigned char const& burnTime) {
     _setBurnTime(burnTime);
@@ -34,16 +111,26 @@ void EzGraver::pause() {
 
 void EzGraver::reset() {
     qDebug() << "resetting";
-    _transmit(0xF9);
+    // The rest of a running upload must not reach the engraver after the reset.
+    _call([this] {
+        _discardUpload();
+        _discardMoves();
+        _moves.clear();
+        _serial->write(QByteArray{1, '\xF9'});
+        _serial->flush();
+    }, true);
 }
 
 void EzGraver::home() {
     qDebug() << "moving to home";
+    // Steps still queued would be executed after homing and offset the position.
+    _call([this] { _discardMoves(); });
     _transmit(0xF3);
 }
 
 void EzGraver::center() {
     qDebug() << "moving to center";
+    _call([this] { _discardMoves(); });
     _transmit(0xFB);
 }
 
@@ -52,24 +139,115 @@ void EzGraver::preview() {
     _transmit(0xF4);
 }
 
+void EzGraver::move(Direction direction, int steps) {
+    _checkOffset(steps, 0);
+    if(steps == 0) {
+        return;
+    }
+
+    qDebug() << "moving" << steps << "steps in direction" << int(direction);
+    QByteArray commands{};
+    commands.reserve(2 * steps);
+    for(int i{0}; i < steps; ++i) {
+        commands.append(StepCommand).append(static_cast<char>(direction));
+    }
+
+    _pendingSteps += steps;
+    _call([this, commands] {
+        _moves.append(commands);
+        if(!_moveTimer->isActive()) {
+            _pumpMoves();
+            _moveTimer->start();
+        }
+    });
+}
+
+void EzGraver::moveBy(int dx, int dy) {
+    _checkOffset(std::abs(dx), std::abs(dy));
+    move(dx < 0 ? Left : Right, std::abs(dx));
+    move(dy < 0 ? Up : Down, std::abs(dy));
+}
+
+void EzGraver::moveTo(int x, int y) {
+    // Nothing is sent if the offset is rejected, the engraver keeps its position.
+    _checkOffset(std::abs(x), std::abs(y));
+    home();
+    moveBy(x, y);
+}
+
+int EzGraver::pendingSteps() const {
+    return _pendingSteps;
+}
+
+void EzGraver::_checkOffset(int dx, int dy) {
+    if(dx < 0 || dx > MaxMoveSteps || dy < 0 || dy > MaxMoveSteps) {
+        throw std::out_of_range{"move exceeds the range of the engraver"};
+    }
+}
+
+void EzGraver::_pumpMoves() {
+    if(_moves.isEmpty()) {
+        _moveTimer->stop();
+        return;
+    }
+    if(_pendingOffset < _pending.size()) {
+        // Steps must not end up inside the image data, they are sent once it has been handed over.
+        return;
+    }
+
+    // No byte of a command queued behind the steps equals the step code, so a step is never split.
+    int length{0};
+    int steps{0};
+    while(length < _moves.size() && steps < MoveBatchSteps) {
+        if(_moves.at(length) == StepCommand) {
+            length += 2;
+            ++steps;
+        } else {
+            ++length;
+        }
+    }
+    _serial->write(_moves.left(length));
+    _serial->flush();
+    _moves.remove(0, length);
+    _pendingSteps -= steps;
+}
+
+void EzGraver::_discardMoves() {
+    // Commands queued behind the steps are kept and sent in order.
+    QByteArray commands{};
+    int steps{0};
+    for(int i{0}; i < _moves.size(); ++i) {
+        if(_moves.at(i) == StepCommand) {
+            ++i;
+            ++steps;
+        } else {
+            commands.append(_moves.at(i));
+        }
+    }
+    if(steps > 0) {
+        qDebug() << "discarding" << steps << "queued steps";
+    }
+    _pendingSteps -= steps;
+    _moves = commands;
+    if(_moves.isEmpty()) {
+        _moveTimer->stop();
+    }
+}
+
 void EzGraver::up() {
-    qDebug() << "moving up";
-    _transmit("\xf5\x01");
+    move(Up, 1);
 }
 
 void EzGraver::down() {
-    qDebug() << "moving down";
-    _transmit("\xf5\x02");
+    move(Down, 1);
 }
 
 void EzGraver::left() {
-    qDebug() << "moving left";
-    _transmit("\xf5\x03");
+    move(Left, 1);
 }
 
 void EzGraver::right() {
-    qDebug() << "moving right";
-    _transmit("\xf5\x04");
+    move(Right, 1);
 }
 
 void EzGraver::erase() {
@@ -77,29 +255,101 @@ void EzGraver::erase() {
     _transmit(QByteArray{8, '\xFE'});
 }
 
-int EzGraver::uploadImage(QImage const& originalImage) {
+QImage EzGraver::convertImage(QImage const& originalImage) {
+    if(originalImage.format() == QImage::Format_Mono && originalImage.size() == QSize{ImageWidth, ImageHeight}) {
+        QImage image{originalImage.mirrored()};
+        image.invertPixels();
+        return image;
+    }
+
     qDebug() << "converting image to bitmap";
     QImage image{originalImage
             .scaled(ImageWidth, ImageHeight)
             .mirrored()
             .convertToFormat(QImage::Format_Mono)};
     image.invertPixels();
+    return image;
+}
 
+QByteArray EzGraver::encodeBitmap(QImage const& bitmap) {
     QByteArray bytes{};
     QBuffer buffer{&bytes};
-    image.save(&buffer, "BMP");
-    return uploadImage(bytes);
+    bitmap.save(&buffer, "BMP");
+    return bytes;
+}
+
+int EzGraver::uploadImage(QImage const& originalImage) {
+    return uploadImage(encodeBitmap(convertImage(originalImage)));
+}
+
+int EzGraver::uploadBitmap(QImage const& bitmap) {
+    return uploadImage(encodeBitmap(bitmap));
+}
+
+int EzGraver::uploadBitmap(std::shared_ptr<MappedBitmap> const& bitmap) {
+    qDebug() << "uploading mapped bitmap";
+    auto data = bitmap->data();
+    _transmitPaced(data);
+    return data.size();
 }
 
 int EzGraver::uploadImage(QByteArray const& image) {
     qDebug() << "uploading image";
-    // Data is chunked in order to get at least some progress updates
-    _transmit(image, 8192);
+    _transmitPaced(image);
     return image.size();
 }
 
 void EzGraver::awaitTransmission(int msecs) {
-    _serial->waitForBytesWritten(msecs);
+    _call([this, msecs] {
+        if(_pendingOffset < _pending.size()) {
+            // Nobody is waiting for progress updates, so there is no reason to hold back any data.
+            _serial->write(_pending.mid(_pendingOffset));
+            _pendingOffset = _pending.size();
+        }
+        while(!_moves.isEmpty()) {
+            // Steps stay paced, so the engraver is not flooded with them.
+            _pumpMoves();
+            _serial->waitForBytesWritten(msecs);
+            QThread::msleep(MoveIntervalMs);
+        }
+        _moveTimer->stop();
+        _serial->waitForBytesWritten(msecs);
+    }, true);
+}
+
+double EzGraver::throughput() const {
+    return _throughput;
+}
+
+QList<Report> EzGraver::readReports() {
+    if(!_ioThread) {
+        return _reportParser.parse(_serial->readAll());
+    }
+
+    QList<Report> reports{};
+    Report report{};
+    while(_reports.pop(report)) {
+        reports.append(report);
+    }
+    if(_overflowed.exchange(false)) {
+        _call([this] { _enqueueReports(); });
+    }
+    return reports;
+}
+
+void EzGraver::_enqueueReports() {
+    _overflow.append(_reportParser.parse(_serial->readAll()));
+    while(!_overflow.isEmpty() && _reports.push(_overflow.first())) {
+        _overflow.removeFirst();
+    }
+    if(!_overflow.isEmpty()) {
+        qDebug() << "report queue full, holding back" << _overflow.size() << "reports";
+        _overflowed = true;
+    }
+}
+
+void EzGraver::_call(std::function<void()> const& function, bool blocking) {
+    callOn(_dispatcher, function, blocking);
 }
 
 std::shared_ptr<QSerialPort> EzGraver::serialPort() {
@@ -112,16 +362,111 @@ void EzGraver::_transmit(unsigned char const& data) {
 
 void EzGraver::_transmit(QByteArray const& data) {
     qDebug() << "transmitting" << data.size() << "bytes:" << data.toHex();
-    _serial->write(data);
-    _serial->flush();
+    _call([this, data] {
+        if(!_moves.isEmpty()) {
+            // Commands wait for the queued steps, so the head does not move during a preview, erase or burn.
+            _moves.append(data);
+            return;
+        }
+        if(_pendingOffset < _pending.size()) {
+            // Commands are queued behind the paced upload, so they never end up inside the image data.
+            _pending.append(data);
+            return;
+        }
+        _serial->write(data);
+        _serial->flush();
+    });
 }
 
-void EzGraver::_transmit(QByteArray const& data, int chunkSize) {
-    qDebug() << "transmitting" << data.size() << "bytes in chunks of size" << chunkSize;
-    for(int i{0}; i < data.size(); i += chunkSize) {
-        _serial->write(data.mid(i, chunkSize));
+void EzGraver::_transmitPaced(QByteArray const& data) {
+    _call([this, data] {
+        qDebug() << "transmitting" << data.size() << "bytes paced in chunks of initially" << _chunkSize() << "bytes";
+        _pending = data;
+        _pendingOffset = 0;
+        _handedOver = 0;
+        _drainedMark = 0;
+        _sampleMark = 0;
+        _rateClock.start();
+        _pumpTimer->start();
+        _pump();
+    });
+}
+
+void EzGraver::_discardUpload() {
+    if(!_pending.isEmpty()) {
+        qDebug() << "discarding" << _pending.size() - _pendingOffset << "bytes of the upload";
+    }
+    _pumpTimer->stop();
+    _pending.clear();
+    _pendingOffset = 0;
+    _serial->clear(QSerialPort::Output);
+}
+
+void EzGraver::_pump() {
+    // Flushing may emit bytesWritten synchronously, which must not re-enter the pump.
+    if(_pending.isEmpty() || _pumping) {
+        return;
+    }
+    _pumping = true;
+    _sampleThroughput();
+
+    // Only keep about one chunk queued: this keeps the link busy while the
+    // bytesWritten notifications stay as fine grained as the chunks themselves.
+    auto chunkSize = _chunkSize();
+    auto queued = _queuedBytes();
+    while(_pendingOffset < _pending.size() && queued < chunkSize) {
+        auto chunk = _pending.mid(_pendingOffset, chunkSize);
+        _serial->write(chunk);
+        _pendingOffset += chunk.size();
+        queued += chunk.size();
+    }
+
+    // The serial port pushes buffered data on its own; flushing is only necessary
+    // as long as the driver is about to run dry.
+    if(_queuedBytes() - _serial->bytesToWrite() < chunkSize / 2) {
         _serial->flush();
     }
+
+    if(_pendingOffset >= _pending.size() && _queuedBytes() == 0) {
+        qDebug() << "paced transmission completed at" << int(_throughput) << "bytes/s";
+        _pumpTimer->stop();
+        _pending.clear();
+        _pendingOffset = 0;
+    }
+    _pumping = false;
+}
+
+void EzGraver::_sampleThroughput() {
+    auto elapsed = _rateClock.elapsed();
+    auto interval = elapsed - _sampleMark;
+    if(interval < SampleIntervalMs) {
+        return;
+    }
+
+    auto drained = _handedOver - (_queuedBytes() - _serial->bytesToWrite());
+    auto rate = (drained - _drainedMark) * 1000.0 / interval;
+    double const previous{_throughput};
+    _throughput = previous > 0 ? 0.7 * previous + 0.3 * rate : rate;
+    _drainedMark = drained;
+    _sampleMark = elapsed;
+}
+
+int EzGraver::_chunkSize() const {
+    // Start off with the nominal line rate (8N1 frames take 10 bits per byte) until a measurement is available.
+    double const measured{_throughput};
+    auto rate = measured > 0 ? measured : _serial->baudRate() / 10.0;
+    return qBound(MinChunkSize, static_cast<int>(rate * ChunkIntervalMs / 1000), MaxChunkSize);
+}
+
+qint64 EzGraver::_queuedBytes() const {
+    qint64 queued{_serial->bytesToWrite()};
+#ifdef Q_OS_LINUX
+    int driverQueued{0};
+    if(::ioctl(_serial->handle(), TIOCOUTQ, &driverQueued) == 0) {
+        queued += driverQueued;
+    }
+#endif
+    return queued;
 }
 
 void EzGraver::requestReady()
@@ -132,7 +477,18 @@ void EzGraver::requestReady()
 
 EzGraver::~EzGraver() {
     qDebug() << "EzGraver is being destroyed, closing serial port";
-    _serial->close();
+    _call([this] {
+        QObject::disconnect(_bytesWrittenConnection);
+        QObject::disconnect(_readyReadConnection);
+        _pumpTimer->stop();
+        _moveTimer->stop();
+        _serial->close();
+    }, true);
+
+    if(_ioThread) {
+        _ioThread->quit();
+        _ioThread->wait();
+    }
 }
 
 QStringList EzGraver::availablePorts() {
@@ -144,20 +500,37 @@ QStringList EzGraver::availablePorts() {
     return result;
 }
 
-std::shared_ptr<EzGraver> EzGraver::create(QString const& portName) {
-    qDebug() << "instantiating EzGraver on port" << portName;
+std::shared_ptr<EzGraver> EzGraver::create(QString const& portName, bool ioThread) {
+    qDebug() << "instantiating EzGraver on port" << portName << (ioThread ? "using an I/O thread" : "");
 
     std::shared_ptr<QSerialPort> serial{new QSerialPort(portName)};
     serial->setBaudRate(QSerialPort::Baud57600, QSerialPort::AllDirections);
     serial->setParity(QSerialPort::Parity::NoParity);
     serial->setDataBits(QSerialPort::DataBits::Data8);
     serial->setStopBits(QSerialPort::StopBits::OneStop);
+    auto dispatcher = new Dispatcher{serial.get()};
+
+    std::unique_ptr<QThread> thread{};
+    if(ioThread) {
+        thread.reset(new QThread{});
+        thread->setObjectName(QString{"EzGraver I/O %1"}.arg(portName));
+        serial->moveToThread(thread.get());
+        thread->start();
+    }
 
-    if(!serial->open(QIODevice::ReadWrite)) {
+    // The port has to be opened on its own thread, so the notifiers are created there.
+    bool opened{false};
+    callOn(dispatcher, [&serial, &opened] { opened = serial->open(QIODevice::ReadWrite); }, true);
+    if(!opened) {
         qDebug() << "failed to establish a connection on port" << portName;
         qDebug() << serial->errorString();
-        throw std::runtime_error{QString{"failed to connect to port %1 (%2)"}.arg(portName, serial->errorString()).toStdString()};
+        auto error = serial->errorString();
+        if(thread) {
+            thread->quit();
+            thread->wait();
+        }
+        throw std::runtime_error{QString{"failed to connect to port %1 (%2)"}.arg(portName, error).toStdString()};
     }
 
-    return std::shared_ptr<EzGraver>{new EzGraver(serial)};
+    return std::shared_ptr<EzGraver>{new EzGraver(serial, std::move(thread), dispatcher)};
 }
@@ -2,13 +2,22 @@
 #define EZGRAVER_H
 
 #include "ezgravercore_global.h"
+#include "report.h"
+#include "mappedbitmap.h"
 
 #include <QStringList>
 #include <QImage>
 #include <QSerialPort>
 #include <QSize>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QThread>
 
 #include <memory>
+#include <atomic>
+#include <functional>
+
+#include "spscqueue.h"
 
 /*!
  * Allows accessing a NEJE engraver using the serial port it was instantiated with.
@@ -24,13 +33,50 @@ struct EZGRAVERCORESHARED_EXPORT EzGraver {
     /*! The image height */
     static int const ImageHeight{512};
 
+    /*! The time in milliseconds a single upload chunk should take to be transmitted. */
+    static int const ChunkIntervalMs{100};
+
+    /*! The smallest chunk size in bytes used while uploading. */
+    static int const MinChunkSize{64};
+
+    /*! The largest chunk size in bytes used while uploading. */
+    static int const MaxChunkSize{8192};
+
+    /*! The number of decoded reports buffered between the I/O thread and the consumer. */
+    static int const ReportQueueSize{16384};
+
+    /*! The largest number of steps a single move may consist of, the size of the work area. */
+    static int const MaxMoveSteps{512};
+
+    /*! The number of steps written at once while moving. */
+    static int const MoveBatchSteps{16};
+
+    /*! The time in milliseconds between two batches of steps. */
+    static int const MoveIntervalMs{40};
+
+    /*!
+     * The directions the engraver can be moved in, valued by their command codes.
+     */
+    enum Direction : unsigned char {
+        Up = 0x01,
+        Down = 0x02,
+        Left = 0x03,
+        Right = 0x04
+    };
+
     /*!
      * Creates an instance and connects to the given \a portName.
      *
+     * If \a ioThread is set, the serial port and the decoding of reports are moved
+     * to a dedicated thread. The signals of \a serialPort() are then emitted on that
+     * thread and the port must not be accessed directly; decoded reports are handed
+     * over through a lock-free queue and are fetched using \a readReports().
+     *
      * \param portName The port the connection should be established to.
+     * \param ioThread \c true if the serial port should be run on its own thread.
      * \return An instance of the EzGraver as a shared pointer.
      */
-    static std::shared_ptr<EzGraver> create(QString const& portName);
+    static std::shared_ptr<EzGraver> create(QString const& portName, bool ioThread=false);
 
     /*!
      * Gets a list of all available ports.
@@ -52,18 +98,57 @@ struct EZGRAVERCORESHARED_EXPORT EzGraver {
      */
     void pause();
 
-    /*! Resets the engraver. */
+    /*! Resets the engraver, discarding the rest of a running upload and all queued steps and commands. */
     void reset();
 
-    /*! Moves the engraver to the home position. */
+    /*! Moves the engraver to the home position, discarding all queued steps. */
     void home();
 
-    /*! Moves the engraver to the center. */
+    /*! Moves the engraver to the center, discarding all queued steps. */
     void center();
 
     /*! Draws a preview of the currently loaded image. */
     void preview();
 
+    /*!
+     * Moves the engraver by the given number of \a steps. Steps are queued and written
+     * in batches of \a MoveBatchSteps, a single write each \a MoveIntervalMs, instead
+     * of writing and flushing every single step. Any other command issued meanwhile is
+     * queued behind the steps.
+     *
+     * \param direction The direction to move in.
+     * \param steps The number of steps, at most \a MaxMoveSteps.
+     * \throw std::out_of_range if \a steps is negative or exceeds \a MaxMoveSteps.
+     */
+    void move(Direction direction, int steps);
+
+    /*!
+     * Moves the engraver by the given offset.
+     *
+     * \param dx The steps to move, positive values move right.
+     * \param dy The steps to move, positive values move down.
+     * \throw std::out_of_range if either offset exceeds \a MaxMoveSteps, nothing is moved.
+     */
+    void moveBy(int dx, int dy);
+
+    /*!
+     * Moves the engraver to the given offset from the home position. The engraver is
+     * homed first and the steps are queued right behind the home command.
+     *
+     * \param x The steps to the right of the home position.
+     * \param y The steps below the home position.
+     * \throw std::out_of_range if either offset exceeds \a MaxMoveSteps, the engraver is not homed.
+     */
+    void moveTo(int x, int y);
+
+    /*!
+     * Gets the number of steps which have not been handed over to the serial port yet.
+     * A move is in flight as long as this is not \c 0.
+     *
+     * \return The number of queued steps.
+     */
+    int pendingSteps() const;
+
     /*! Moves the engraver up. */
     void up();
 
@@ -90,6 +175,25 @@ struct EZGRAVERCORESHARED_EXPORT EzGraver {
      */
     void requestReady();
 
+    /*!
+     * Converts the given \a image into a device ready bitmap. The image is scaled,
+     * mirrored, converted to a monochrome bitmap and inverted, which results in
+     * every white pixel being engraved. Monochrome images of the engraver's dimensions
+     * are only mirrored and inverted, i.e. every black pixel of them is engraved.
+     *
+     * \param image The image to convert.
+     * \return The monochrome bitmap as it is expected by the engraver.
+     */
+    static QImage convertImage(QImage const& image);
+
+    /*!
+     * Encodes the given device ready \a bitmap into the byte array being sent to the engraver.
+     *
+     * \param bitmap The bitmap as returned by \a convertImage.
+     * \return The encoded bitmap.
+     */
+    static QByteArray encodeBitmap(QImage const& bitmap);
+
     /*!
      * Uploads the given \a image to the EEPROM. It is mandatory to use \a erase()
      * it prior uploading an image. The image will automatically be scaled, inverted,
@@ -100,9 +204,29 @@ struct EZGRAVERCORESHARED_EXPORT EzGraver {
      */
     int uploadImage(QImage const& image);
 
+    /*!
+     * Uploads the given device ready \a bitmap to the EEPROM without any further
+     * conversion. It is mandatory to use \a erase() it prior uploading a bitmap.
+     *
+     * \param bitmap The bitmap as returned by \a convertImage.
+     * \return The number of bytes being sent to the device.
+     */
+    int uploadBitmap(QImage const& bitmap);
+
+    /*!
+     * Uploads the device ready bitmap built from the given monochrome image file to the
+     * EEPROM. It is mandatory to use \a erase() it prior uploading a bitmap.
+     *
+     * \param bitmap The mapped monochrome image.
+     * \return The number of bytes being sent to the device.
+     */
+    int uploadBitmap(std::shared_ptr<MappedBitmap> const& bitmap);
+
     /*!
      * Uploads any given \a image byte array to the EEPROM. It has to be a monochrome
-     * bitmap of the dimensions 512x512. Every white pixel is being engraved.
+     * bitmap of the dimensions 512x512. Every white pixel is being engraved. The image
+     * is sent paced, commands issued meanwhile are sent once the image has been handed
+     * over to the serial port.
      *
      * \param image The image byte array to upload to the EEPROM.
      * \return The number of bytes being sent to the device.
@@ -111,13 +235,34 @@ struct EZGRAVERCORESHARED_EXPORT EzGraver {
 
     /*!
      * Waits until the current serial port buffer is fully written to the device.
+     * Any pending upload data is handed over to the serial port at once, queued
+     * steps are still written in paced batches.
      *
      * \param msecs The time in milliseconds to await the transmission to complete.
      */
     void awaitTransmission(int msecs=-1);
 
     /*!
-     * Gets the serialport used by the EzGraver instance.
+     * Gets the effective upload throughput measured on this connection. The value
+     * is derived from the bytes actually drained by the serial driver and is kept
+     * after an upload has finished.
+     *
+     * \return The measured throughput in bytes per second or \c 0 if nothing has been measured yet.
+     */
+    double throughput() const;
+
+    /*!
+     * Reads all data received from the engraver and decodes it into status reports.
+     * Incomplete reports are kept until the next invocation. If the engraver runs on
+     * an I/O thread, the reports decoded by that thread are taken from the queue.
+     *
+     * \return The reports received since the last invocation.
+     */
+    QList<Report> readReports();
+
+    /*!
+     * Gets the serialport used by the EzGraver instance. If an I/O thread is used,
+     * the port may only be used to connect to its signals.
      *
      * \return The serial port used.
      */
@@ -127,12 +272,48 @@ struct EZGRAVERCORESHARED_EXPORT EzGraver {
     virtual ~EzGraver();
 
 private:
+    /*! The minimum time in milliseconds between two throughput samples. */
+    static int const SampleIntervalMs{50};
+
     std::shared_ptr<QSerialPort> _serial;
-    explicit EzGraver(std::shared_ptr<QSerialPort> serial);
+    std::unique_ptr<QThread> _ioThread;
+    QObject* _dispatcher;
+    std::unique_ptr<QTimer> _pumpTimer;
+    std::unique_ptr<QTimer> _moveTimer;
+    QByteArray _moves;
+    std::atomic<int> _pendingSteps;
+    QMetaObject::Connection _bytesWrittenConnection;
+    QMetaObject::Connection _readyReadConnection;
+    QElapsedTimer _rateClock;
+    QByteArray _pending;
+    int _pendingOffset;
+    qint64 _handedOver;
+    qint64 _drainedMark;
+    qint64 _sampleMark;
+    std::atomic<double> _throughput;
+    bool _pumping;
+    ReportParser _reportParser;
+    SpscQueue<Report, ReportQueueSize> _reports;
+    QList<Report> _overflow;
+    std::atomic<bool> _overflowed;
+
+    explicit EzGraver(std::shared_ptr<QSerialPort> serial, std::unique_ptr<QThread> ioThread, QObject* dispatcher);
+
+    void _call(std::function<void()> const& function, bool blocking=false);
+    void _enqueueReports();
 
     void _transmit(unsigned char const& data);
     void _transmit(QByteArray const& data);
-    void _transmit(QByteArray const& data, int chunkSize);
+    void _transmitPaced(QByteArray const& data);
+
+    void _discardUpload();
+    void _pump();
+    void _pumpMoves();
+    void _discardMoves();
+    static void _checkOffset(int dx, int dy);
+    void _sampleThroughput();
+    int _chunkSize() const;
+    qint64 _queuedBytes() const;
 
     void _setBurnTime(unsigned char const& burnTime);
 };
@@ -0,0 +1,119 @@
+#include "filterpipeline.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QLibrary>
+#include <QPluginLoader>
+#include <QDebug>
+
+#include <cstring>
+#include <utility>
+
+#include "parallel.h"
+
+char const FilterPipeline::PluginFolder[]{"filters"};
+
+FilterPipeline::FilterPipeline() : _stages{}, _signature{} {}
+
+QString FilterPipeline::defaultDirectory() {
+    return QDir{QCoreApplication::applicationDirPath()}.filePath(PluginFolder);
+}
+
+int FilterPipeline::load(QString const& directory) {
+    int loaded{0};
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+    hash.addData(_signature);
+    for(auto const& file : QDir{directory}.entryInfoList(QDir::Files, QDir::Name)) {
+        if(!QLibrary::isLibrary(file.fileName())) {
+            continue;
+        }
+
+        // The instance stays alive as long as the plugin is not unloaded explicitly.
+        QPluginLoader loader{file.absoluteFilePath()};
+        auto stage = qobject_cast<FilterStage*>(loader.instance());
+        if(!stage) {
+            qDebug() << "skipping plugin" << file.fileName() << loader.errorString();
+            continue;
+        }
+
+        qDebug() << "loaded filter stage" << stage->name() << "from" << file.fileName();
+        QByteArray identity{};
+        QDataStream stream{&identity, QIODevice::WriteOnly};
+        stream << file.fileName() << stage->name() << file.lastModified().toMSecsSinceEpoch() << file.size();
+        hash.addData(identity);
+        _stages.append(stage);
+        ++loaded;
+    }
+
+    if(loaded > 0) {
+        _signature = hash.result();
+    }
+    return loaded;
+}
+
+bool FilterPipeline::isEmpty() const {
+    return _stages.isEmpty();
+}
+
+QStringList FilterPipeline::names() const {
+    QStringList names{};
+    for(auto const stage : _stages) {
+        names.append(stage->name());
+    }
+    return names;
+}
+
+QByteArray FilterPipeline::signature() const {
+    return _signature;
+}
+
+QImage FilterPipeline::apply(QImage const& image) const {
+    if(_stages.isEmpty() || image.isNull()) {
+        return image;
+    }
+
+    auto const source = image.format() == QImage::Format_ARGB32 ? image : image.convertToFormat(QImage::Format_ARGB32);
+    auto const width = source.width();
+    auto const height = source.height();
+    auto const bytesPerLine = (width * 4 + Alignment - 1) / Alignment * Alignment;
+    auto const size = static_cast<size_t>(bytesPerLine) * height;
+    auto input = static_cast<uchar*>(qMallocAligned(size, Alignment));
+    auto output = static_cast<uchar*>(qMallocAligned(size, Alignment));
+    if(!input || !output) {
+        qDebug() << "failed to allocate filter buffers for size" << source.size();
+        qFreeAligned(input);
+        qFreeAligned(output);
+        return image;
+    }
+
+    Parallel::forEachBand(height, [&](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            std::memcpy(input + y * bytesPerLine, source.constScanLine(y), width * 4);
+        }
+    });
+
+    // Every stage reads the complete output of the previous one, which stays unchanged while
+    // the bands are written, so a stage may read the neighbouring lines of its band.
+    for(auto const stage : _stages) {
+        auto const filter = [&](int first, int last) {
+            std::memcpy(output + first * bytesPerLine, input + first * bytesPerLine,
+                        static_cast<size_t>(last - first) * bytesPerLine);
+            FilterBatch const batch{input, output + first * bytesPerLine, bytesPerLine, width, height, first, last - first};
+            stage->process(batch);
+        };
+        if(stage->isSerial()) {
+            filter(0, height);
+        } else {
+            Parallel::forEachBand(height, filter);
+        }
+        std::swap(input, output);
+    }
+    qFreeAligned(output);
+
+    // The image takes over the buffer and frees it once it is no longer referenced.
+    return QImage{input, width, height, bytesPerLine, QImage::Format_ARGB32, qFreeAligned, input};
+}
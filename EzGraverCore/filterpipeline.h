@@ -0,0 +1,82 @@
+#ifndef FILTERPIPELINE_H
+#define FILTERPIPELINE_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QList>
+#include <QStringList>
+#include <QByteArray>
+
+#include "filterstage.h"
+
+/*!
+ * The preprocessing stages loaded from plugins, applied one after another. Every stage
+ * reads the aligned output of the previous one and writes a second buffer, on parallel
+ * bands of scanlines unless it is serial. The buffers are swapped between the stages.
+ */
+class EZGRAVERCORESHARED_EXPORT FilterPipeline {
+public:
+    /*! The alignment of every scanline in bytes, sufficient for any vector instruction set. */
+    static int const Alignment{64};
+
+    /*! The folder next to the executable the plugins are loaded from by default. */
+    static char const PluginFolder[];
+
+    /*!
+     * Creates an empty pipeline.
+     */
+    FilterPipeline();
+
+    /*!
+     * Gets the directory the plugins are loaded from by default.
+     *
+     * \return The plugin folder next to the executable.
+     */
+    static QString defaultDirectory();
+
+    /*!
+     * Loads every plugin implementing \a FilterStage in the given \a directory and appends
+     * its stage. The stages are ordered by the file names of the plugins.
+     *
+     * \param directory The directory to search for plugins.
+     * \return The number of stages loaded.
+     */
+    int load(QString const& directory);
+
+    /*!
+     * Gets if no stage has been loaded.
+     *
+     * \return \c true if the pipeline does not change any image.
+     */
+    bool isEmpty() const;
+
+    /*!
+     * Gets the names of the loaded stages in the order they are applied.
+     *
+     * \return The names of the stages.
+     */
+    QStringList names() const;
+
+    /*!
+     * Gets a value identifying the loaded plugins, changing as soon as a plugin file changes.
+     *
+     * \return The signature of the pipeline.
+     */
+    QByteArray signature() const;
+
+    /*!
+     * Applies all stages to the given \a image.
+     *
+     * \param image The image to filter.
+     * \return The filtered image in the format \c QImage::Format_ARGB32, or \a image if the
+     *         pipeline is empty.
+     */
+    QImage apply(QImage const& image) const;
+
+private:
+    QList<FilterStage*> _stages;
+    QByteArray _signature;
+};
+
+#endif // FILTERPIPELINE_H
@@ -0,0 +1,80 @@
+#ifndef FILTERSTAGE_H
+#define FILTERSTAGE_H
+
+#include <QtPlugin>
+#include <QString>
+
+/*!
+ * A block of consecutive scanlines handed to a filter stage. The stage reads the complete
+ * output of the previous stage from \a input and writes the lines of its block to \a lines,
+ * which start out as a copy of the same lines of the input. Both images share the format
+ * \c QImage::Format_ARGB32, every line starts at an address aligned to
+ * \a FilterPipeline::Alignment bytes and is padded up to the next aligned address.
+ */
+struct FilterBatch {
+    /*! The first pixel of the first line of the whole input image, which must not be modified. */
+    uchar const* input;
+
+    /*! The first pixel of the first line of the block within the output image. */
+    uchar* lines;
+
+    /*! The distance between two lines of both images in bytes, a multiple of the alignment. */
+    int bytesPerLine;
+
+    /*! The number of pixels per line. */
+    int width;
+
+    /*! The height of the whole image. */
+    int height;
+
+    /*! The row of the first line of the block within the whole image. */
+    int first;
+
+    /*! The number of lines of the block. */
+    int rows;
+};
+
+/*!
+ * The interface of preprocessing plugins, applied to the image placed onto the canvas
+ * of the engraver before it is binarized. A stage processes whole blocks of scanlines,
+ * so the inner loops can be vectorized. The blocks of an image are processed in parallel,
+ * hence \a process must be reentrant and may only modify the lines of its block. Since
+ * the input stays unchanged until every block is done, a stage may read any of its lines,
+ * e.g. the neighbourhood of a halftone cell. Stages carrying state from one line to the
+ * next, such as error diffusion, declare themselves serial and receive a single block.
+ *
+ * Plugins implement this interface in a \c QObject declaring \c Q_INTERFACES(FilterStage)
+ * and \c Q_PLUGIN_METADATA(IID FilterStage_iid).
+ */
+class FilterStage {
+public:
+    virtual ~FilterStage() {}
+
+    /*!
+     * Gets the name of the stage shown to the user.
+     *
+     * \return The name of the stage.
+     */
+    virtual QString name() const = 0;
+
+    /*!
+     * Gets if the lines depend on the results of the lines above, so the stage has to
+     * process the whole image as a single block on one thread.
+     *
+     * \return \c true if the stage must not be split into parallel blocks.
+     */
+    virtual bool isSerial() const { return false; }
+
+    /*!
+     * Filters the given block of scanlines from the input into the output.
+     *
+     * \param batch The block to filter.
+     */
+    virtual void process(FilterBatch const& batch) const = 0;
+};
+
+#define FilterStage_iid "org.ezgraver.FilterStage/2.0"
+
+Q_DECLARE_INTERFACE(FilterStage, FilterStage_iid)
+
+#endif // FILTERSTAGE_H
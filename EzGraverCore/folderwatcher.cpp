@@ -0,0 +1,166 @@
+#include "folderwatcher.h"
+
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+char const FolderWatcher::DoneFolder[]{"done"};
+char const FolderWatcher::FailedFolder[]{"failed"};
+
+FolderWatcher::FolderWatcher(QString const& directory, QObject* parent)
+        : QObject{parent}, _directory{QDir{directory}.absolutePath()}, _reported{}, _observed{}, _pollTimer{},
+          _inotify{-1}, _notifier{} {
+    connect(&_pollTimer, &QTimer::timeout, this, &FolderWatcher::_poll);
+}
+
+FolderWatcher::~FolderWatcher() {
+#ifdef Q_OS_LINUX
+    _notifier.reset();
+    if(_inotify >= 0) {
+        ::close(_inotify);
+    }
+#endif
+}
+
+bool FolderWatcher::start() {
+    if(!QFileInfo{_directory}.isDir()) {
+        qDebug() << "watched directory does not exist:" << _directory;
+        return false;
+    }
+
+    if(_watchDirectory()) {
+        // Files present before the watch was added may still be written to. Like without
+        // notifications they are reported once they stayed unchanged for a scan, unless
+        // their writer closes them earlier.
+        QTimer::singleShot(0, this, &FolderWatcher::_poll);
+        QTimer::singleShot(PollDelay, this, &FolderWatcher::_poll);
+    } else {
+        qDebug() << "file notifications unavailable, polling" << _directory;
+        _pollTimer.start(PollDelay);
+        QTimer::singleShot(0, this, &FolderWatcher::_poll);
+    }
+    return true;
+}
+
+QString FolderWatcher::directory() const {
+    return _directory;
+}
+
+QString FolderWatcher::archive(QString const& fileName, bool succeeded, QJsonObject const& record) {
+    QFileInfo info{fileName};
+    QDir target{info.dir().filePath(succeeded ? DoneFolder : FailedFolder)};
+    if(!target.mkpath(".")) {
+        qDebug() << "failed to create" << target.path();
+        return QString{};
+    }
+
+    auto name = info.fileName();
+    if(target.exists(name)) {
+        auto const stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmsszzz");
+        name = info.suffix().isEmpty()
+                ? QString{"%1-%2"}.arg(info.completeBaseName(), stamp)
+                : QString{"%1-%2.%3"}.arg(info.completeBaseName(), stamp, info.suffix());
+    }
+
+    auto destination = target.filePath(name);
+    if(!QFile::rename(fileName, destination)) {
+        qDebug() << "failed to move" << fileName << "to" << destination;
+        return QString{};
+    }
+
+    QSaveFile file{destination + ".json"};
+    if(!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument{record}.toJson()) < 0
+            || !file.commit()) {
+        qDebug() << "failed to write the record of" << destination;
+    }
+    qDebug() << "archived" << fileName << "as" << destination;
+    return destination;
+}
+
+bool FolderWatcher::_watchDirectory() {
+#ifdef Q_OS_LINUX
+    _inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(_inotify < 0) {
+        return false;
+    }
+    auto const mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+    if(::inotify_add_watch(_inotify, QFile::encodeName(_directory).constData(), mask) < 0) {
+        ::close(_inotify);
+        _inotify = -1;
+        return false;
+    }
+
+    _notifier.reset(new QSocketNotifier{_inotify, QSocketNotifier::Read});
+    connect(_notifier.get(), &QSocketNotifier::activated, this, &FolderWatcher::_readEvents);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FolderWatcher::_readEvents() {
+#ifdef Q_OS_LINUX
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length{0};
+    while((length = ::read(_inotify, buffer, sizeof(buffer))) > 0) {
+        for(char* current{buffer}; current < buffer + length; ) {
+            auto event = reinterpret_cast<inotify_event*>(current);
+            current += sizeof(inotify_event) + event->len;
+            if(!event->len || (event->mask & IN_ISDIR)) {
+                continue;
+            }
+
+            auto name = QFile::decodeName(event->name);
+            if(event->mask & (IN_MOVED_FROM | IN_DELETE)) {
+                // A file of the same name may be dropped again later on.
+                _reported.remove(name);
+            } else {
+                _report(name);
+            }
+        }
+    }
+#endif
+}
+
+void FolderWatcher::_poll() {
+    QMap<QString, Observation> observed{};
+    for(auto const& info : QDir{_directory}.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed)) {
+        Observation const current{info.size(), info.lastModified()};
+        auto const previous = _observed.constFind(info.fileName());
+        if(previous != _observed.cend() && previous->size == current.size && previous->modified == current.modified) {
+            _report(info.fileName());
+        }
+        observed.insert(info.fileName(), current);
+    }
+
+    // Forget files which are gone, so they are reported again if dropped once more.
+    for(auto const& name : _reported.values()) {
+        if(!observed.contains(name)) {
+            _reported.remove(name);
+        }
+    }
+    _observed = observed;
+}
+
+void FolderWatcher::_report(QString const& name) {
+    if(name.startsWith('.') || _reported.contains(name)) {
+        return;
+    }
+
+    auto const fileName = QDir{_directory}.filePath(name);
+    if(!QFileInfo{fileName}.isFile()) {
+        return;
+    }
+
+    _reported.insert(name);
+    qDebug() << "file ready:" << fileName;
+    emit fileReady(fileName);
+}
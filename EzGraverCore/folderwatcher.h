@@ -0,0 +1,106 @@
+#ifndef FOLDERWATCHER_H
+#define FOLDERWATCHER_H
+
+#include "ezgravercore_global.h"
+
+#include <QObject>
+#include <QJsonObject>
+#include <QSocketNotifier>
+#include <QDateTime>
+#include <QTimer>
+#include <QMap>
+#include <QSet>
+
+#include <memory>
+
+/*!
+ * Watches a directory for new images and reports every file once it has been
+ * written completely. On Linux, inotify reports files as soon as their writer
+ * closed them or they have been moved into the directory. Other platforms fall
+ * back to polling and wait until the size and the modification time of a file
+ * stopped changing. Hidden files are ignored, so writers may use them while the
+ * content is incomplete.
+ */
+class EZGRAVERCORESHARED_EXPORT FolderWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    /*! The subdirectory successfully processed files are moved to. */
+    static char const DoneFolder[];
+
+    /*! The subdirectory failed files are moved to. */
+    static char const FailedFolder[];
+
+    /*! The delay between two scans if the directory has to be polled or files are present on start. */
+    static int const PollDelay{1000};
+
+    /*!
+     * Creates a new instance watching the given \a directory.
+     *
+     * \param directory The directory to watch.
+     * \param parent The parent of the watcher.
+     */
+    explicit FolderWatcher(QString const& directory, QObject* parent=NULL);
+
+    /*!
+     * Frees all required resources upon deconstruction.
+     */
+    virtual ~FolderWatcher();
+
+    /*!
+     * Starts watching. Files already present are reported as soon as they did not change
+     * for \a PollDelay milliseconds or their writer closed them.
+     *
+     * \return \c true if the directory exists and is watched.
+     */
+    bool start();
+
+    /*!
+     * Gets the watched directory.
+     *
+     * \return The absolute path of the directory.
+     */
+    QString directory() const;
+
+    /*!
+     * Moves a processed file into the done or failed subdirectory of its directory
+     * and writes the given \a record next to it, named like the file with the suffix
+     * \c .json appended. Files of the same name already archived are not overwritten.
+     *
+     * \param fileName The file to move.
+     * \param succeeded \c true if the file has been processed successfully.
+     * \param record The result record to store.
+     * \return The new path of the file or an empty string on failure.
+     */
+    static QString archive(QString const& fileName, bool succeeded, QJsonObject const& record);
+
+signals:
+    /*!
+     * Fired as soon as a file has been completed, at most once per file as long as
+     * it stays in the directory.
+     *
+     * \param fileName The absolute path of the file.
+     */
+    void fileReady(QString const& fileName);
+
+private:
+    /*! The state of a file observed by polling. */
+    struct Observation {
+        qint64 size;
+        QDateTime modified;
+    };
+
+    QString _directory;
+    QSet<QString> _reported;
+    QMap<QString, Observation> _observed;
+    QTimer _pollTimer;
+    int _inotify;
+    std::unique_ptr<QSocketNotifier> _notifier;
+
+    bool _watchDirectory();
+    void _readEvents();
+    void _poll();
+    void _report(QString const& name);
+};
+
+#endif // FOLDERWATCHER_H
@@ -0,0 +1,106 @@
+#include "framereader.h"
+
+#include <QIODevice>
+#include <QtEndian>
+#include <QDebug>
+
+#include <stdexcept>
+#include <cstring>
+
+#include "imageloader.h"
+
+char const FrameReader::Magic[]{"EZGF"};
+
+FrameReader::FrameReader(QIODevice& device) : _device(device), _frameCount{0} {}
+
+bool FrameReader::next(QImage& image) {
+    uchar header[HeaderSize];
+    if(!_read(reinterpret_cast<char*>(header), 1)) {
+        return false;
+    }
+    if(!_read(reinterpret_cast<char*>(header) + 1, HeaderSize - 1)) {
+        throw std::runtime_error{"stream ended within a frame header"};
+    }
+    if(std::memcmp(header, Magic, 4) != 0) {
+        throw std::runtime_error{"frame magic expected, the stream is out of sync"};
+    }
+
+    auto const type = static_cast<Type>(header[4]);
+    auto const width = qFromBigEndian<quint16>(header + 5);
+    auto const height = qFromBigEndian<quint16>(header + 7);
+    auto const length = qFromBigEndian<quint32>(header + 9);
+    if(length > MaxPayloadSize) {
+        throw std::runtime_error{QString{"frame payload of %1 bytes exceeds the limit"}.arg(length).toStdString()};
+    }
+
+    QByteArray payload{static_cast<int>(length), Qt::Uninitialized};
+    if(!_read(payload.data(), length)) {
+        throw std::runtime_error{"stream ended within a frame payload"};
+    }
+
+    image = decode(type, width, height, payload);
+    ++_frameCount;
+    qDebug() << "read frame" << _frameCount << "of type" << type << "with" << length << "bytes";
+    return true;
+}
+
+int FrameReader::frameCount() const {
+    return _frameCount;
+}
+
+QImage FrameReader::decode(Type type, int width, int height, QByteArray const& payload) {
+    QImage image{};
+    switch(type) {
+    case Encoded:
+        image = ImageLoader::load(payload);
+        if(image.isNull()) {
+            throw std::runtime_error{"failed to decode the encoded frame"};
+        }
+        return image;
+    case Grayscale:
+        image = QImage{width, height, QImage::Format_Grayscale8};
+        break;
+    case Monochrome:
+        image = QImage{width, height, QImage::Format_Mono};
+        image.setColorTable(QVector<QRgb>{qRgb(255, 255, 255), qRgb(0, 0, 0)});
+        break;
+    default:
+        throw std::runtime_error{QString{"unknown frame type %1"}.arg(type).toStdString()};
+    }
+
+    auto const rowSize = type == Grayscale ? width : (width + 7) / 8;
+    if(width == 0 || height == 0 || payload.size() != rowSize * height) {
+        throw std::runtime_error{QString{"raw frame of %1x%2 pixels does not match its payload of %3 bytes"}
+                                 .arg(width).arg(height).arg(payload.size()).toStdString()};
+    }
+
+    // Rows of the image are aligned to 32 bits, rows of the payload are packed.
+    for(int y{0}; y < height; ++y) {
+        std::memcpy(image.scanLine(y), payload.constData() + y * rowSize, rowSize);
+    }
+    return image;
+}
+
+QByteArray FrameReader::header(Type type, int width, int height, quint32 length) {
+    QByteArray header{HeaderSize, Qt::Uninitialized};
+    auto data = reinterpret_cast<uchar*>(header.data());
+    std::memcpy(data, Magic, 4);
+    data[4] = type;
+    qToBigEndian<quint16>(width, data + 5);
+    qToBigEndian<quint16>(height, data + 7);
+    qToBigEndian<quint32>(length, data + 9);
+    return header;
+}
+
+bool FrameReader::_read(char* data, qint64 size) {
+    // Pipes deliver partial reads, wait until the whole block has arrived or the stream ended.
+    while(size > 0) {
+        auto const count = _device.read(data, size);
+        if(count < 0 || (count == 0 && !_device.waitForReadyRead(-1))) {
+            return false;
+        }
+        data += count;
+        size -= count;
+    }
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef FRAMEREADER_H
+#define FRAMEREADER_H
+
+#include "ezgravercore_global.h"
+
+#include <QByteArray>
+#include <QImage>
+
+class QIODevice;
+
+/*!
+ * Reads a stream of image frames, e.g. from stdin or a named pipe, without any
+ * temporary files. Every frame starts with a header of 13 bytes:
+ *
+ * \li the magic \c EZGF,
+ * \li the type as a single byte,
+ * \li the width and the height as big-endian 16-bit integers,
+ * \li the length of the payload as big-endian 32-bit integer.
+ *
+ * Encoded frames carry any image file supported by \a ImageLoader and ignore the
+ * dimensions. Raw grayscale frames carry one byte per pixel with 0 being black,
+ * raw monochrome frames carry rows padded to whole bytes, most significant bit
+ * first, with set bits being burned.
+ */
+class EZGRAVERCORESHARED_EXPORT FrameReader {
+public:
+    /*! The magic starting every frame. */
+    static char const Magic[];
+
+    /*! The size of the frame header in bytes. */
+    static int const HeaderSize{13};
+
+    /*! The largest accepted payload, anything larger is considered a corrupted stream. */
+    static quint32 const MaxPayloadSize{64 * 1024 * 1024};
+
+    /*!
+     * The types of frames.
+     */
+    enum Type : quint8 {
+        /*! An encoded image file such as PNG, BMP or SVG. */
+        Encoded,
+        /*! Raw 8-bit grayscale pixels. */
+        Grayscale,
+        /*! Raw 1-bit pixels. */
+        Monochrome
+    };
+
+    /*!
+     * Creates a reader for the given \a device, which has to be open already.
+     *
+     * \param device The device to read the frames from.
+     */
+    explicit FrameReader(QIODevice& device);
+
+    /*!
+     * Reads the next frame, blocking until it is available.
+     *
+     * \param image The image the frame is decoded into.
+     * \return \c false if the stream ended before another frame started.
+     * \throw std::runtime_error if the stream is corrupted or ends within a frame.
+     */
+    bool next(QImage& image);
+
+    /*!
+     * Gets the number of frames read so far.
+     *
+     * \return The frame count.
+     */
+    int frameCount() const;
+
+    /*!
+     * Decodes the payload of a frame.
+     *
+     * \param type The type of the frame.
+     * \param width The width of raw frames.
+     * \param height The height of raw frames.
+     * \param payload The payload of the frame.
+     * \return The decoded image, raw monochrome frames use the format \c QImage::Format_Mono
+     * with black pixels to be burned.
+     * \throw std::runtime_error if the payload cannot be decoded.
+     */
+    static QImage decode(Type type, int width, int height, QByteArray const& payload);
+
+    /*!
+     * Creates the header of a frame, allowing to produce streams for testing.
+     *
+     * \param type The type of the frame.
+     * \param width The width of the frame.
+     * \param height The height of the frame.
+     * \param length The length of the payload.
+     * \return The encoded header.
+     */
+    static QByteArray header(Type type, int width, int height, quint32 length);
+
+private:
+    QIODevice& _device;
+    int _frameCount;
+
+    bool _read(char* data, qint64 size);
+};
+
+#endif // FRAMEREADER_H
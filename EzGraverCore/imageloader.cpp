@@ -0,0 +1,78 @@
+#include "imageloader.h"
+
+#include <QFileInfo>
+#include <QPainter>
+#include <QSvgRenderer>
+#include <QDebug>
+
+#include "ezgraver.h"
+
+namespace {
+
+QImage render(QSvgRenderer& renderer, QSize const& canvas) {
+    auto size = renderer.defaultSize().isEmpty() ? canvas : renderer.defaultSize().scaled(canvas, Qt::KeepAspectRatio);
+    qDebug() << "rendering vector image at" << size;
+
+    // Transparent areas would otherwise end up burned.
+    QImage image{size, QImage::Format_ARGB32_Premultiplied};
+    image.fill(Qt::white);
+    QPainter painter{&image};
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+    renderer.render(&painter, QRectF{QPointF{0, 0}, size});
+    painter.end();
+
+    return image;
+}
+
+}
+
+QString ImageLoader::nameFilter() {
+    return "Images (*.png *.jpeg *.jpg *.bmp *.svg *.svgz)";
+}
+
+bool ImageLoader::isVector(QString const& fileName) {
+    auto suffix = QFileInfo{fileName}.suffix().toLower();
+    return suffix == "svg" || suffix == "svgz";
+}
+
+QImage ImageLoader::load(QString const& fileName, QSize const& canvas) {
+    if(!isVector(fileName)) {
+        QImage image{};
+        return image.load(fileName) ? image : QImage{};
+    }
+
+    QSvgRenderer renderer{fileName};
+    if(!renderer.isValid()) {
+        qDebug() << "failed to parse vector image" << fileName;
+        return QImage{};
+    }
+    return render(renderer, canvas);
+}
+
+QImage ImageLoader::load(QString const& fileName) {
+    return load(fileName, QSize{EzGraver::ImageWidth, EzGraver::ImageHeight});
+}
+
+QImage ImageLoader::load(QByteArray const& data, QSize const& canvas) {
+    auto image = QImage::fromData(data);
+    if(!image.isNull()) {
+        return image;
+    }
+
+    QSvgRenderer renderer{data};
+    if(!renderer.isValid()) {
+        qDebug() << "failed to decode image data of" << data.size() << "bytes";
+        return QImage{};
+    }
+    return render(renderer, canvas);
+}
+
+QImage ImageLoader::load(QByteArray const& data) {
+    return load(data, QSize{EzGraver::ImageWidth, EzGraver::ImageHeight});
+}
+
+void ImageLoader::useOffscreenPlatform() {
+    if(!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+}
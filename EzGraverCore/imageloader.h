@@ -0,0 +1,75 @@
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+/*!
+ * Loads raster and vector images. Vector images are rendered directly at the
+ * requested resolution instead of going through a large intermediate raster.
+ */
+struct EZGRAVERCORESHARED_EXPORT ImageLoader {
+    /*!
+     * Gets the file dialog filter listing all supported image formats.
+     *
+     * \return The name filter.
+     */
+    static QString nameFilter();
+
+    /*!
+     * Checks if the given file is a vector image.
+     *
+     * \param fileName The file to check.
+     * \return \c true if the file is rendered instead of decoded.
+     */
+    static bool isVector(QString const& fileName);
+
+    /*!
+     * Loads the given image file. Vector images are rendered antialiased on white
+     * ground, fitted into \a canvas while keeping their aspect ratio. Raster images
+     * are returned as they are.
+     *
+     * \param fileName The file to load.
+     * \param canvas The size vector images are fitted into.
+     * \return The loaded image or a null image on failure.
+     */
+    static QImage load(QString const& fileName, QSize const& canvas);
+
+    /*!
+     * Loads the given image file fitted into the canvas of the engraver.
+     *
+     * \param fileName The file to load.
+     * \return The loaded image or a null image on failure.
+     */
+    static QImage load(QString const& fileName);
+
+    /*!
+     * Decodes an image file held in memory, such as an image read from a pipe.
+     * Data which is no raster image is tried to be rendered as vector image.
+     *
+     * \param data The content of the image file.
+     * \param canvas The size vector images are fitted into.
+     * \return The decoded image or a null image on failure.
+     */
+    static QImage load(QByteArray const& data, QSize const& canvas);
+
+    /*!
+     * Decodes an image file held in memory fitted into the canvas of the engraver.
+     *
+     * \param data The content of the image file.
+     * \return The decoded image or a null image on failure.
+     */
+    static QImage load(QByteArray const& data);
+
+    /*!
+     * Selects the platform plugin rendering without a display unless a platform has been
+     * chosen already. Rendering the text of vector images requires a \c QGuiApplication,
+     * hence command line tools invoke this before creating theirs.
+     */
+    static void useOffscreenPlatform();
+};
+
+#endif // IMAGELOADER_H
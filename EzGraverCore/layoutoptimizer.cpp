@@ -0,0 +1,113 @@
+#include "layoutoptimizer.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+#include <QDebug>
+
+#include <algorithm>
+
+#include "ezgraver.h"
+#include "budget.h"
+#include "nesting.h"
+#include "parallel.h"
+
+namespace {
+
+bool burned(QImage const& raster, int x, int y) {
+    return raster.constScanLine(y)[x >> 3] & (0x80 >> (x & 7));
+}
+
+QImage place(QImage const& design, QPoint const& position) {
+    return Nesting::render(QVector<QImage>{design}, QVector<NestPlacement>{NestPlacement{0, position, false}});
+}
+
+}
+
+double LayoutOptimizer::travelTime(BitmapStats const& stats) {
+    if(stats.burnCount == 0) {
+        return 0.0;
+    }
+    return 2 * std::max(stats.bounds.left(), stats.bounds.top()) / TravelSpeed;
+}
+
+QImage LayoutOptimizer::rotate(QImage const& raster, int quarterTurns) {
+    auto const turns = (quarterTurns % 4 + 4) % 4;
+    if(turns == 0) {
+        return raster;
+    }
+
+    auto const width = raster.width();
+    auto const height = raster.height();
+    QImage rotated{turns % 2 ? QSize{height, width} : raster.size(), QImage::Format_Mono};
+    rotated.setColorTable(QVector<QRgb>{qRgb(255, 255, 255), qRgb(0, 0, 0)});
+    rotated.fill(0);
+
+    Parallel::forEachBand(rotated.height(), [&](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto line = rotated.scanLine(y);
+            for(int x{0}; x < rotated.width(); ++x) {
+                // Maps the target (x, y) to the source pixel for clockwise rotations.
+                auto const set = turns == 1 ? burned(raster, y, height - 1 - x)
+                               : turns == 2 ? burned(raster, width - 1 - x, height - 1 - y)
+                               : burned(raster, width - 1 - y, x);
+                if(set) {
+                    line[x >> 3] |= static_cast<uchar>(0x80 >> (x & 7));
+                }
+            }
+        }
+    });
+    return rotated;
+}
+
+QVector<Layout> LayoutOptimizer::evaluate(QImage const& raster, int burnTime, DurationEstimator const& estimator) {
+    auto const design = Nesting::crop(raster);
+    if(design.isNull()) {
+        return QVector<Layout>{};
+    }
+
+    QVector<QImage> rotations{};
+    for(int turns{0}; turns < 4; ++turns) {
+        rotations.append(rotate(design, turns));
+    }
+
+    // The current layout comes first, so it wins ties.
+    auto const bounds = Budget::analyze(raster).bounds;
+    auto const center = bounds.center();
+    QVector<Layout> candidates{};
+    for(int turns{0}; turns < 4; ++turns) {
+        auto const size = rotations[turns].size();
+        auto const right = EzGraver::ImageWidth - size.width();
+        auto const bottom = EzGraver::ImageHeight - size.height();
+        QPoint centered{qBound(0, center.x() - size.width() / 2, right), qBound(0, center.y() - size.height() / 2, bottom)};
+        if(turns == 0) {
+            centered = bounds.topLeft();
+        }
+        for(auto const& position : {centered, QPoint{0, 0}, QPoint{right, 0}, QPoint{0, bottom}, QPoint{right, bottom}}) {
+            candidates.append(Layout{turns, position, BitmapStats{0, QRect{}, 0, 0}, 0.0});
+        }
+    }
+
+    QtConcurrent::blockingMap(candidates, [&](Layout& candidate) {
+        candidate.stats = BitmapStats::analyze(EzGraver::convertImage(place(rotations[candidate.quarterTurns], candidate.position)));
+        candidate.seconds = estimator.estimate(candidate.stats, burnTime) + travelTime(candidate.stats);
+    });
+    qDebug() << "evaluated" << candidates.size() << "layouts";
+    return candidates;
+}
+
+int LayoutOptimizer::fastest(QVector<Layout> const& candidates) {
+    int best{0};
+    for(int i{1}; i < candidates.size(); ++i) {
+        if(candidates[i].seconds < candidates[best].seconds) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+QImage LayoutOptimizer::render(QImage const& raster, Layout const& layout) {
+    auto const design = Nesting::crop(raster);
+    if(design.isNull()) {
+        return raster;
+    }
+    return place(rotate(design, layout.quarterTurns), layout.position);
+}
@@ -0,0 +1,87 @@
+#ifndef LAYOUTOPTIMIZER_H
+#define LAYOUTOPTIMIZER_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QPoint>
+#include <QVector>
+
+#include "bitmapstats.h"
+#include "durationestimator.h"
+
+/*!
+ * An orientation and position of a design on the canvas along with its predicted duration.
+ */
+struct EZGRAVERCORESHARED_EXPORT Layout {
+    /*! The number of clockwise rotations by 90 degrees. */
+    int quarterTurns;
+
+    /*! The top left corner of the cropped and rotated design on the canvas. */
+    QPoint position;
+
+    /*! The statistics of the device ready bitmap of the layout. */
+    BitmapStats stats;
+
+    /*! The predicted duration of the burn phase in seconds, including the travel of the head. */
+    double seconds;
+};
+
+/*!
+ * Searches the orientation and position of a converted design with the lowest predicted
+ * burn time. The occupied rows and spans change with the orientation and are weighted by
+ * the duration estimator, the position changes the travel of the head from its home to
+ * the first burned pixel and back.
+ */
+struct EZGRAVERCORESHARED_EXPORT LayoutOptimizer {
+    /*! The speed of the head travelling without burning in pixels per second. */
+    static constexpr double TravelSpeed{200.0};
+
+    /*!
+     * Estimates the time the head travels from its home to the burned pixels and back.
+     * Both axes are assumed to move simultaneously.
+     *
+     * \param stats The statistics of the device ready bitmap.
+     * \return The travel time in seconds.
+     */
+    static double travelTime(BitmapStats const& stats);
+
+    /*!
+     * Rotates the given \a raster clockwise by multiples of 90 degrees without any loss.
+     *
+     * \param raster The cropped raster with set bits to be burned, as returned by \a Nesting::crop.
+     * \param quarterTurns The number of clockwise rotations by 90 degrees.
+     * \return The rotated raster with set bits to be burned.
+     */
+    static QImage rotate(QImage const& raster, int quarterTurns);
+
+    /*!
+     * Evaluates the four orientations of the design, each centered on its current position
+     * and moved into every corner of the canvas. The candidates are evaluated in parallel.
+     *
+     * \param raster The converted image in the format \c QImage::Format_Mono with black pixels to be burned.
+     * \param burnTime The burn time of the job.
+     * \param estimator The estimator predicting the duration of the burn phase.
+     * \return The candidates, the first one being the current layout, or none if nothing is burned.
+     */
+    static QVector<Layout> evaluate(QImage const& raster, int burnTime, DurationEstimator const& estimator);
+
+    /*!
+     * Gets the candidate with the lowest predicted duration.
+     *
+     * \param candidates The candidates as returned by \a evaluate.
+     * \return The index of the fastest candidate, \c 0 if the current layout is at least as fast.
+     */
+    static int fastest(QVector<Layout> const& candidates);
+
+    /*!
+     * Renders the given \a raster in the given \a layout.
+     *
+     * \param raster The converted image in the format \c QImage::Format_Mono with black pixels to be burned.
+     * \param layout The layout as returned by \a evaluate for the same raster.
+     * \return The image in the format \c QImage::Format_Mono with black pixels to be burned.
+     */
+    static QImage render(QImage const& raster, Layout const& layout);
+};
+
+#endif // LAYOUTOPTIMIZER_H
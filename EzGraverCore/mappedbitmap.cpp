@@ -0,0 +1,168 @@
+#include "mappedbitmap.h"
+
+#include <QImage>
+#include <QFile>
+#include <QtEndian>
+#include <QDebug>
+
+#include <algorithm>
+
+#include "ezgraver.h"
+
+namespace {
+
+/*! The number of bytes of a single bitmap row. */
+int const RowBytes{EzGraver::ImageWidth / 8};
+
+/*! The number of bytes of the pixel data. */
+int const DataBytes{RowBytes * EzGraver::ImageHeight};
+
+/*! The layout of the bitmaps produced by EzGraver::encodeBitmap. */
+struct Reference {
+    /*! Everything preceding the pixel data, including the palette. */
+    QByteArray header;
+    /*! The value of a pixel data byte consisting of burned pixels only. */
+    uchar burnByte;
+};
+
+Reference createReference() {
+    QImage black{EzGraver::ImageWidth, EzGraver::ImageHeight, QImage::Format_RGB32};
+    black.fill(Qt::black);
+    auto encoded = EzGraver::encodeBitmap(EzGraver::convertImage(black));
+    auto offset = qFromLittleEndian<quint32>(reinterpret_cast<uchar const*>(encoded.constData()) + 10);
+    return Reference{encoded.left(offset), static_cast<uchar>(encoded.at(offset))};
+}
+
+Reference const& reference() {
+    static Reference const instance{createReference()};
+    return instance;
+}
+
+bool isPbmWhitespace(uchar c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/*! Reads the next decimal header value of a PBM, skipping whitespace and comments. */
+int readPbmValue(uchar const* data, qint64 size, qint64& offset) {
+    while(offset < size && (isPbmWhitespace(data[offset]) || data[offset] == '#')) {
+        if(data[offset] == '#') {
+            while(offset < size && data[offset] != '\n') {
+                ++offset;
+            }
+        } else {
+            ++offset;
+        }
+    }
+
+    int value{-1};
+    while(offset < size && data[offset] >= '0' && data[offset] <= '9') {
+        value = (value < 0 ? 0 : value * 10) + (data[offset++] - '0');
+    }
+    return value;
+}
+
+}
+
+MappedBitmap::MappedBitmap() : _data{}, _stats{0, QRect{}, 0, 0} {}
+
+MappedBitmap::~MappedBitmap() {}
+
+std::shared_ptr<MappedBitmap> MappedBitmap::open(QString const& fileName) {
+    QFile file{fileName};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    // The rows are copied into the device ready bitmap, the mapping is not needed afterwards.
+    std::shared_ptr<MappedBitmap> bitmap{new MappedBitmap{}};
+    auto size = file.size();
+    auto data = file.map(0, size);
+    auto mapped = data && (bitmap->_mapBmp(data, size) || bitmap->_mapPbm(data, size));
+    if(data) {
+        file.unmap(data);
+    }
+    file.close();
+    if(!mapped) {
+        return nullptr;
+    }
+
+    bitmap->_analyze();
+    qDebug() << "mapped monochrome bitmap" << fileName;
+    return bitmap;
+}
+
+QByteArray MappedBitmap::data() const {
+    return _data;
+}
+
+int MappedBitmap::burnCount() const {
+    return _stats.burnCount;
+}
+
+BitmapStats MappedBitmap::stats() const {
+    return _stats;
+}
+
+bool MappedBitmap::_mapBmp(uchar const* data, qint64 size) {
+    // The layout (data offset, header size, dimensions including the bottom-up orientation,
+    // bit depth, compression and palette) has to match the reference. The image size,
+    // resolution and color count fields (bytes 34 to 53) are irrelevant for the engraver.
+    auto const& header = reference().header;
+    if(size < header.size() + DataBytes) {
+        return false;
+    }
+    auto expected = reinterpret_cast<uchar const*>(header.constData());
+    auto matches = [data, expected](int from, int to) { return std::equal(data + from, data + to, expected + from); };
+    if(!matches(0, 2) || !matches(10, 34) || !matches(54, header.size())) {
+        return false;
+    }
+
+    // The file shows the design like any other image, so it is mirrored and inverted exactly
+    // like EzGraver::convertImage does, just on the raw rows instead of a decoded image.
+    _data = header;
+    _data.resize(header.size() + DataBytes);
+    auto source = data + header.size();
+    auto target = reinterpret_cast<uchar*>(_data.data()) + header.size();
+    for(int row{0}; row < EzGraver::ImageHeight; ++row) {
+        auto const line = source + (EzGraver::ImageHeight - 1 - row) * RowBytes;
+        std::transform(line, line + RowBytes, target + row * RowBytes, [](uchar byte) { return static_cast<uchar>(~byte); });
+    }
+    return true;
+}
+
+bool MappedBitmap::_mapPbm(uchar const* data, qint64 size) {
+    if(size < 2 || data[0] != 'P' || data[1] != '4') {
+        return false;
+    }
+
+    qint64 offset{2};
+    auto width = readPbmValue(data, size, offset);
+    auto height = readPbmValue(data, size, offset);
+    if(width != EzGraver::ImageWidth || height != EzGraver::ImageHeight || offset >= size || !isPbmWhitespace(data[offset])) {
+        return false;
+    }
+    ++offset;
+    if(size - offset < DataBytes) {
+        return false;
+    }
+
+    // PBM rows are top-down with set bits being black, which is exactly the row order
+    // of the mirrored bitmap as written bottom-up to a BMP. Only the polarity may differ.
+    // Hence black pixels are burned and the design keeps its orientation, like for BMPs.
+    auto const& ref = reference();
+    _data = ref.header;
+    _data.append(reinterpret_cast<char const*>(data + offset), DataBytes);
+    if(ref.burnByte != 0xFF) {
+        auto pixels = reinterpret_cast<uchar*>(_data.data()) + ref.header.size();
+        std::transform(pixels, pixels + DataBytes, pixels, [](uchar byte) { return static_cast<uchar>(~byte); });
+    }
+    return true;
+}
+
+void MappedBitmap::_analyze() {
+    // The rows are stored bottom-up, the statistics refer to the rows of the decoded bitmap.
+    auto const& ref = reference();
+    auto pixels = reinterpret_cast<uchar const*>(_data.constData()) + ref.header.size();
+    auto top = pixels + (EzGraver::ImageHeight - 1) * RowBytes;
+    _stats = BitmapStats::analyze(top, EzGraver::ImageWidth, EzGraver::ImageHeight, -RowBytes, ref.burnByte == 0xFF ? 1 : 0);
+}
@@ -0,0 +1,68 @@
+#ifndef MAPPEDBITMAP_H
+#define MAPPEDBITMAP_H
+
+#include "ezgravercore_global.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+
+#include "bitmapstats.h"
+
+/*!
+ * A monochrome image of the engraver's dimensions, which is read through a memory mapping
+ * and turned into the device ready bitmap on its raw rows without decoding it. The file is
+ * unmapped and closed as soon as the bitmap has been built. Accepted are 1-bit
+ * BMPs laid out exactly like the ones produced by \a EzGraver::encodeBitmap (bottom-up
+ * rows, same header size and palette) and binary PBMs (P4). Both are interpreted like
+ * any other image: black pixels are burned and the design keeps its orientation, the
+ * result equals \a EzGraver::convertImage of the decoded image.
+ */
+class EZGRAVERCORESHARED_EXPORT MappedBitmap {
+public:
+    /*!
+     * Reads the given file if it contains a monochrome image of the engraver's dimensions.
+     *
+     * \param fileName The file to read.
+     * \return The mapped bitmap or \c nullptr if the file needs to be converted.
+     */
+    static std::shared_ptr<MappedBitmap> open(QString const& fileName);
+
+    /*!
+     * Gets the encoded bitmap as it is sent to the engraver.
+     *
+     * \return The encoded bitmap.
+     */
+    QByteArray data() const;
+
+    /*!
+     * Gets the number of pixels being burned.
+     *
+     * \return The number of pixels being burned.
+     */
+    int burnCount() const;
+
+    /*!
+     * Gets the statistics of the device ready bitmap, gathered from its raw rows.
+     *
+     * \return The statistics as returned by \a BitmapStats::analyze for the decoded bitmap.
+     */
+    BitmapStats stats() const;
+
+    MappedBitmap(MappedBitmap const&) = delete;
+    MappedBitmap& operator=(MappedBitmap const&) = delete;
+    virtual ~MappedBitmap();
+
+private:
+    QByteArray _data;
+    BitmapStats _stats;
+
+    MappedBitmap();
+
+    bool _mapBmp(uchar const* data, qint64 size);
+    bool _mapPbm(uchar const* data, qint64 size);
+    void _analyze();
+};
+
+#endif // MAPPEDBITMAP_H
@@ -0,0 +1,179 @@
+#include "nesting.h"
+
+#include <QRect>
+#include <QDebug>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "budget.h"
+#include "parallel.h"
+
+namespace {
+
+/*!
+ * The free space of the canvas as maximal rectangles, i.e. free rectangles which may
+ * overlap each other but are not contained in one another.
+ */
+class FreeRectangles {
+public:
+    explicit FreeRectangles(QSize const& size) : _free{QRect{QPoint{0, 0}, size}} {}
+
+    /*! Finds the position with the best short side fit, returns \c false if the size does not fit. */
+    bool find(QSize const& size, QPoint& position, int& score) const {
+        score = std::numeric_limits<int>::max();
+        for(auto const& rect : _free) {
+            if(rect.width() < size.width() || rect.height() < size.height()) {
+                continue;
+            }
+            auto const fit = std::min(rect.width() - size.width(), rect.height() - size.height());
+            if(fit < score) {
+                score = fit;
+                position = rect.topLeft();
+            }
+        }
+        return score != std::numeric_limits<int>::max();
+    }
+
+    void occupy(QRect const& used) {
+        QVector<QRect> next{};
+        for(auto const& rect : _free) {
+            if(!rect.intersects(used)) {
+                next.append(rect);
+                continue;
+            }
+
+            // Split the free rectangle into the up to four maximal parts around the used one.
+            if(used.left() > rect.left()) {
+                next.append(QRect{rect.left(), rect.top(), used.left() - rect.left(), rect.height()});
+            }
+            if(used.right() < rect.right()) {
+                next.append(QRect{used.right() + 1, rect.top(), rect.right() - used.right(), rect.height()});
+            }
+            if(used.top() > rect.top()) {
+                next.append(QRect{rect.left(), rect.top(), rect.width(), used.top() - rect.top()});
+            }
+            if(used.bottom() < rect.bottom()) {
+                next.append(QRect{rect.left(), used.bottom() + 1, rect.width(), rect.bottom() - used.bottom()});
+            }
+        }
+
+        // Drop every rectangle contained in another one.
+        _free.clear();
+        for(int i{0}; i < next.size(); ++i) {
+            bool contained{false};
+            for(int j{0}; j < next.size() && !contained; ++j) {
+                contained = i != j && next[j].contains(next[i]) && (next[i] != next[j] || j < i);
+            }
+            if(!contained) {
+                _free.append(next[i]);
+            }
+        }
+    }
+
+private:
+    QVector<QRect> _free;
+};
+
+bool burned(QImage const& raster, int x, int y) {
+    return raster.constScanLine(y)[x >> 3] & (0x80 >> (x & 7));
+}
+
+}
+
+QImage Nesting::crop(QImage const& raster) {
+    auto const stats = Budget::analyze(raster);
+    if(stats.burnCount == 0) {
+        return QImage{};
+    }
+
+    // Normalize the palette so set bits are burned, as expected by render.
+    auto cropped = raster.copy(stats.bounds).convertToFormat(QImage::Format_Mono);
+    if(qGray(cropped.color(1)) > qGray(cropped.color(0))) {
+        cropped.invertPixels();
+    }
+    cropped.setColorTable(QVector<QRgb>{qRgb(255, 255, 255), qRgb(0, 0, 0)});
+    return cropped;
+}
+
+NestResult Nesting::pack(QVector<QImage> const& pieces, int spacing, bool allowRotation, QSize const& canvas) {
+    QVector<int> order(pieces.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&pieces](int a, int b) {
+        return pieces[a].width() * pieces[a].height() > pieces[b].width() * pieces[b].height();
+    });
+
+    // Every piece reserves the spacing to its right and bottom, which the canvas is extended by.
+    FreeRectangles free{canvas + QSize{spacing, spacing}};
+    NestResult result{QImage{}, QVector<NestPlacement>{}, QList<int>{}};
+    for(auto const index : order) {
+        auto const& piece = pieces[index];
+        if(piece.isNull()) {
+            result.unplaced.append(index);
+            continue;
+        }
+
+        QPoint position{}, rotatedPosition{};
+        int score{0}, rotatedScore{0};
+        auto const size = piece.size() + QSize{spacing, spacing};
+        auto const fits = free.find(size, position, score);
+        auto const rotatedFits = allowRotation && free.find(size.transposed(), rotatedPosition, rotatedScore);
+        if(!fits && !rotatedFits) {
+            result.unplaced.append(index);
+            continue;
+        }
+
+        auto const rotated = rotatedFits && (!fits || rotatedScore < score);
+        auto const origin = rotated ? rotatedPosition : position;
+        free.occupy(QRect{origin, rotated ? size.transposed() : size});
+        result.placements.append(NestPlacement{index, origin, rotated});
+    }
+
+    if(!result.unplaced.isEmpty()) {
+        qDebug() << result.unplaced.size() << "pieces did not fit onto the canvas";
+    }
+    return result;
+}
+
+QImage Nesting::render(QVector<QImage> const& pieces, QVector<NestPlacement> const& placements, QSize const& canvas) {
+    QImage raster{canvas, QImage::Format_Mono};
+    raster.setColorTable(QVector<QRgb>{qRgb(255, 255, 255), qRgb(0, 0, 0)});
+    raster.fill(0);
+
+    Parallel::forEachBand(canvas.height(), [&](int first, int last) {
+        for(auto const& placement : placements) {
+            auto const& piece = pieces[placement.index];
+            auto const width = placement.rotated ? piece.height() : piece.width();
+            auto const height = placement.rotated ? piece.width() : piece.height();
+            auto const top = std::max(first, placement.position.y());
+            auto const bottom = std::min(last, placement.position.y() + height);
+            for(int y{top}; y < bottom; ++y) {
+                auto line = raster.scanLine(y);
+                auto const row = y - placement.position.y();
+                for(int column{0}; column < width; ++column) {
+                    // Rotating clockwise maps the target (column, row) to the source (row, height - 1 - column).
+                    auto const set = placement.rotated
+                            ? burned(piece, row, piece.height() - 1 - column)
+                            : burned(piece, column, row);
+                    if(set) {
+                        auto const x = placement.position.x() + column;
+                        line[x >> 3] |= static_cast<uchar>(0x80 >> (x & 7));
+                    }
+                }
+            }
+        }
+    });
+    return raster;
+}
+
+NestResult Nesting::nest(QVector<QImage> const& pieces, int spacing, bool allowRotation) {
+    QVector<QImage> cropped{};
+    for(auto const& piece : pieces) {
+        cropped.append(crop(piece));
+    }
+
+    auto result = pack(cropped, spacing, allowRotation);
+    result.raster = render(cropped, result.placements);
+    return result;
+}
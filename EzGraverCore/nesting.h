@@ -0,0 +1,90 @@
+#ifndef NESTING_H
+#define NESTING_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QPoint>
+#include <QSize>
+#include <QVector>
+#include <QList>
+
+#include "ezgraver.h"
+
+/*!
+ * The position of a piece on the nested canvas.
+ */
+struct EZGRAVERCORESHARED_EXPORT NestPlacement {
+    /*! The index of the piece. */
+    int index;
+
+    /*! The top left corner of the piece on the canvas. */
+    QPoint position;
+
+    /*! \c true if the piece has been rotated by 90 degrees clockwise. */
+    bool rotated;
+};
+
+/*!
+ * The outcome of nesting several pieces.
+ */
+struct EZGRAVERCORESHARED_EXPORT NestResult {
+    /*! The composite in the format \c QImage::Format_Mono with black pixels to be burned. */
+    QImage raster;
+
+    /*! The placed pieces. */
+    QVector<NestPlacement> placements;
+
+    /*! The indexes of the pieces which did not fit onto the canvas. */
+    QList<int> unplaced;
+};
+
+/*!
+ * Packs several small converted designs onto one canvas, so the erase, upload and burn
+ * overhead of a job is paid once for all of them. The pieces are cropped to the tight
+ * bounding box of their burned pixels and packed by the maximal rectangles algorithm.
+ */
+struct EZGRAVERCORESHARED_EXPORT Nesting {
+    /*!
+     * Crops the given converted \a raster to the bounding box of its burned pixels.
+     *
+     * \param raster The image in the format \c QImage::Format_Mono with black pixels to be burned.
+     * \return The cropped raster or a null image if nothing is burned.
+     */
+    static QImage crop(QImage const& raster);
+
+    /*!
+     * Packs the given \a pieces onto the canvas, largest first.
+     *
+     * \param pieces The cropped rasters to pack.
+     * \param spacing The minimal distance between two pieces in pixels.
+     * \param allowRotation \c true if pieces may be rotated by 90 degrees.
+     * \param canvas The size of the canvas.
+     * \return The placements, without the composite being rendered.
+     */
+    static NestResult pack(QVector<QImage> const& pieces, int spacing, bool allowRotation,
+                           QSize const& canvas=QSize{EzGraver::ImageWidth, EzGraver::ImageHeight});
+
+    /*!
+     * Renders the placed pieces in parallel bands of rows.
+     *
+     * \param pieces The cropped rasters.
+     * \param placements The placements as returned by \a pack.
+     * \param canvas The size of the canvas.
+     * \return The composite in the format \c QImage::Format_Mono with black pixels to be burned.
+     */
+    static QImage render(QVector<QImage> const& pieces, QVector<NestPlacement> const& placements,
+                         QSize const& canvas=QSize{EzGraver::ImageWidth, EzGraver::ImageHeight});
+
+    /*!
+     * Packs and renders the given \a pieces.
+     *
+     * \param pieces The converted rasters, cropped before packing.
+     * \param spacing The minimal distance between two pieces in pixels.
+     * \param allowRotation \c true if pieces may be rotated by 90 degrees.
+     * \return The placements and the composite.
+     */
+    static NestResult nest(QVector<QImage> const& pieces, int spacing, bool allowRotation);
+};
+
+#endif // NESTING_H
@@ -0,0 +1,28 @@
+#include "parallel.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+#include <QThreadPool>
+#include <QVector>
+#include <QPair>
+
+#include <algorithm>
+
+void Parallel::forEachBand(int rows, std::function<void(int first, int last)> const& body) {
+    forEachBand(rows, MinimumBandHeight, body);
+}
+
+void Parallel::forEachBand(int rows, int minimumBandHeight, std::function<void(int first, int last)> const& body) {
+    auto threads = std::max(1, QThreadPool::globalInstance()->maxThreadCount());
+    // A few bands per thread balance the load without paying too much for scheduling.
+    auto bandHeight = std::max(std::max(1, minimumBandHeight), (rows + threads * 4 - 1) / (threads * 4));
+    if(threads == 1 || rows <= bandHeight) {
+        body(0, rows);
+        return;
+    }
+
+    QVector<QPair<int, int>> bands{};
+    for(int first{0}; first < rows; first += bandHeight) {
+        bands.append(qMakePair(first, std::min(rows, first + bandHeight)));
+    }
+    QtConcurrent::blockingMap(bands, [&body](QPair<int, int> const& band) { body(band.first, band.second); });
+}
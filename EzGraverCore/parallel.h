@@ -0,0 +1,36 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "ezgravercore_global.h"
+
+#include <functional>
+
+/*!
+ * Helpers to split image processing into horizontal bands processed on the global thread pool.
+ */
+struct EZGRAVERCORESHARED_EXPORT Parallel {
+    /*! The smallest number of rows processed by a single task. */
+    static int const MinimumBandHeight{16};
+
+    /*!
+     * Invokes \a body for disjoint bands of rows covering \a rows rows and waits for
+     * all of them to finish. Small inputs are processed on the calling thread.
+     *
+     * \param rows The number of rows to process.
+     * \param body The function processing the rows from \a first (inclusive) to \a last (exclusive).
+     */
+    static void forEachBand(int rows, std::function<void(int first, int last)> const& body);
+
+    /*!
+     * Invokes \a body for disjoint bands of at least \a minimumBandHeight rows covering
+     * \a rows rows and waits for all of them to finish. Coarse units of work, such as
+     * column strips, pass a smaller minimum than single rows.
+     *
+     * \param rows The number of rows to process.
+     * \param minimumBandHeight The smallest number of rows processed by a single task.
+     * \param body The function processing the rows from \a first (inclusive) to \a last (exclusive).
+     */
+    static void forEachBand(int rows, int minimumBandHeight, std::function<void(int first, int last)> const& body);
+};
+
+#endif // PARALLEL_H
@@ -0,0 +1,121 @@
+#include "portwatcher.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+#include "ezgraver.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+PortWatcher::PortWatcher(QObject* parent)
+        : QObject{parent}, _ports{}, _enumeration{}, _settleTimer{}, _pollTimer{}, _rescanPending{false},
+          _inotify{-1}, _notifier{} {
+    connect(&_enumeration, &QFutureWatcher<QStringList>::finished, this, &PortWatcher::_enumerated);
+
+    _settleTimer.setSingleShot(true);
+    _settleTimer.setInterval(SettleDelay);
+    connect(&_settleTimer, &QTimer::timeout, this, &PortWatcher::_rescan);
+
+    connect(&_pollTimer, &QTimer::timeout, this, &PortWatcher::_rescan);
+    if(!_watchDevices()) {
+        qDebug() << "device notifications unavailable, polling ports";
+        _pollTimer.start(PollDelay);
+    }
+
+    _rescan();
+}
+
+PortWatcher::~PortWatcher() {
+    _enumeration.waitForFinished();
+#ifdef Q_OS_LINUX
+    _notifier.reset();
+    if(_inotify >= 0) {
+        ::close(_inotify);
+    }
+#endif
+}
+
+QStringList PortWatcher::ports() const {
+    return _ports;
+}
+
+bool PortWatcher::_watchDevices() {
+#ifdef Q_OS_LINUX
+    _inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(_inotify < 0) {
+        return false;
+    }
+    if(::inotify_add_watch(_inotify, "/dev", IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB) < 0) {
+        ::close(_inotify);
+        _inotify = -1;
+        return false;
+    }
+
+    _notifier.reset(new QSocketNotifier{_inotify, QSocketNotifier::Read});
+    connect(_notifier.get(), &QSocketNotifier::activated, this, &PortWatcher::_devicesChanged);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PortWatcher::_devicesChanged() {
+#ifdef Q_OS_LINUX
+    // Drain all pending events, only serial devices are of any interest.
+    alignas(inotify_event) char buffer[4096];
+    bool relevant{false};
+    ssize_t length{0};
+    while((length = ::read(_inotify, buffer, sizeof(buffer))) > 0) {
+        for(char* current{buffer}; current < buffer + length; ) {
+            auto event = reinterpret_cast<inotify_event*>(current);
+            QByteArray name{event->len ? event->name : ""};
+            relevant |= name.startsWith("tty") || name.startsWith("rfcomm");
+            current += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    if(relevant) {
+        // udev creates the node first and adjusts it afterwards, wait until it settled.
+        _settleTimer.start();
+    }
+#endif
+}
+
+void PortWatcher::_rescan() {
+    if(_enumeration.isRunning()) {
+        _rescanPending = true;
+        return;
+    }
+    _enumeration.setFuture(QtConcurrent::run(&EzGraver::availablePorts));
+}
+
+void PortWatcher::_enumerated() {
+    auto ports = _enumeration.result();
+    if(_rescanPending) {
+        _rescanPending = false;
+        _rescan();
+    }
+
+    if(ports == _ports) {
+        return;
+    }
+
+    auto previous = _ports;
+    _ports = ports;
+    for(auto const& port : previous) {
+        if(!ports.contains(port)) {
+            qDebug() << "port removed:" << port;
+            emit portRemoved(port);
+        }
+    }
+    for(auto const& port : ports) {
+        if(!previous.contains(port)) {
+            qDebug() << "port added:" << port;
+            emit portAdded(port);
+        }
+    }
+    emit portsChanged(ports);
+}
@@ -0,0 +1,86 @@
+#ifndef PORTWATCHER_H
+#define PORTWATCHER_H
+
+#include "ezgravercore_global.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <memory>
+
+/*!
+ * Watches the available serial ports and notifies about added and removed ports.
+ * On Linux, changes of the device directory are observed using inotify, other
+ * platforms fall back to polling. The ports are always enumerated on a background
+ * thread and signals are only emitted if the list actually changed.
+ */
+class EZGRAVERCORESHARED_EXPORT PortWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    /*! The delay between two enumerations if the ports have to be polled. */
+    static int const PollDelay{1000};
+
+    /*! The delay used to coalesce bursts of device changes into a single enumeration. */
+    static int const SettleDelay{250};
+
+    /*!
+     * Creates a new instance with the given \a parent and enumerates the ports.
+     *
+     * \param parent The parent of the watcher.
+     */
+    explicit PortWatcher(QObject* parent=NULL);
+
+    /*!
+     * Frees all required resources upon deconstruction.
+     */
+    virtual ~PortWatcher();
+
+    /*!
+     * Gets the ports found by the latest enumeration.
+     *
+     * \return The available ports.
+     */
+    QStringList ports() const;
+
+signals:
+    /*!
+     * Fired as soon as a port became available.
+     *
+     * \param port The name of the port.
+     */
+    void portAdded(QString const& port);
+
+    /*!
+     * Fired as soon as a port disappeared.
+     *
+     * \param port The name of the port.
+     */
+    void portRemoved(QString const& port);
+
+    /*!
+     * Fired after \a portAdded and \a portRemoved as soon as the list of ports changed.
+     *
+     * \param ports The available ports.
+     */
+    void portsChanged(QStringList const& ports);
+
+private:
+    QStringList _ports;
+    QFutureWatcher<QStringList> _enumeration;
+    QTimer _settleTimer;
+    QTimer _pollTimer;
+    bool _rescanPending;
+    int _inotify;
+    std::unique_ptr<QSocketNotifier> _notifier;
+
+    bool _watchDevices();
+    void _devicesChanged();
+    void _rescan();
+    void _enumerated();
+};
+
+#endif // PORTWATCHER_H
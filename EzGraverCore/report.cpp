@@ -0,0 +1,48 @@
+#include "report.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+qint64 Report::now() {
+    static QElapsedTimer const clock{[] {
+        QElapsedTimer timer{};
+        timer.start();
+        return timer;
+    }()};
+    return clock.elapsed();
+}
+
+QList<Report> ReportParser::parse(QByteArray const& data) {
+    _buffer += data;
+
+    QList<Report> reports{};
+    auto const time = Report::now();
+    int offset{0};
+    while(offset < _buffer.size()) {
+        auto type = static_cast<unsigned char>(_buffer[offset]);
+        if(type == 0xFF) {
+            if(_buffer.size() - offset < PixelReportSize) {
+                break;
+            }
+            auto byte = [this, offset](int i) { return static_cast<unsigned char>(_buffer[offset + i]); };
+            reports.append(Report{Report::BurnedPixel, byte(1)*100 + byte(2), byte(3)*100 + byte(4), time});
+            offset += PixelReportSize;
+        } else if(type == 0x65) {
+            reports.append(Report{Report::Ready, 0, 0, time});
+            ++offset;
+        } else if(type == 0x66) {
+            reports.append(Report{Report::Complete, 0, 0, time});
+            ++offset;
+        } else {
+            qDebug() << "received unknown data" << QString::number(type, 16);
+            ++offset;
+        }
+    }
+
+    _buffer.remove(0, offset);
+    return reports;
+}
+
+void ReportParser::clear() {
+    _buffer.clear();
+}
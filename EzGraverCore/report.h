@@ -0,0 +1,67 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "ezgravercore_global.h"
+
+#include <QByteArray>
+#include <QList>
+
+/*!
+ * A single status report sent by the engraver.
+ */
+struct EZGRAVERCORESHARED_EXPORT Report {
+    /*! The kinds of reports sent by the engraver. */
+    enum Type {
+        /*! A pixel has been burned (0xFF followed by the coordinates). */
+        BurnedPixel,
+        /*! The engraver is ready after an upload (0x65). */
+        Ready,
+        /*! The engraving process has been completed (0x66). */
+        Complete
+    };
+
+    /*! The type of the report. */
+    Type type;
+
+    /*! The x coordinate of a burned pixel, otherwise \c 0. */
+    int x;
+
+    /*! The y coordinate of a burned pixel, otherwise \c 0. */
+    int y;
+
+    /*! The time in milliseconds the report has been received at, see \a now. */
+    qint64 time;
+
+    /*!
+     * Gets the monotonic time reports are stamped with upon receipt.
+     *
+     * \return The milliseconds elapsed since an arbitrary, fixed reference.
+     */
+    static qint64 now();
+};
+
+/*!
+ * Decodes the byte stream received from the engraver into reports. Incomplete
+ * reports are kept until the remaining bytes have been received.
+ */
+class EZGRAVERCORESHARED_EXPORT ReportParser {
+public:
+    /*! The size of a burned pixel report in bytes. */
+    static int const PixelReportSize{5};
+
+    /*!
+     * Appends the given \a data to the receive buffer and decodes all complete reports.
+     *
+     * \param data The bytes received from the engraver.
+     * \return The reports decoded from the buffer.
+     */
+    QList<Report> parse(QByteArray const& data);
+
+    /*! Discards any buffered incomplete report. */
+    void clear();
+
+private:
+    QByteArray _buffer;
+};
+
+#endif // REPORT_H
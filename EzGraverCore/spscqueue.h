@@ -0,0 +1,62 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/*!
+ * A bounded lock-free queue for exactly one producing and one consuming thread.
+ * The capacity has to be a power of two.
+ */
+template<typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "the capacity has to be a power of two");
+
+public:
+    SpscQueue() : _buffer{}, _head{0}, _tail{0} {}
+
+    SpscQueue(SpscQueue const&) = delete;
+    SpscQueue& operator=(SpscQueue const&) = delete;
+
+    /*!
+     * Appends the given \a value. May only be invoked by the producing thread.
+     *
+     * \param value The value to append.
+     * \return \c false if the queue is full.
+     */
+    bool push(T const& value) {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        if(tail - _head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        _buffer[tail & (Capacity - 1)] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * Removes the oldest value and stores it in \a value. May only be invoked by the consuming thread.
+     *
+     * \param value Receives the removed value.
+     * \return \c false if the queue is empty.
+     */
+    bool pop(T& value) {
+        auto head = _head.load(std::memory_order_relaxed);
+        if(head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = _buffer[head & (Capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> _buffer;
+    std::atomic<std::size_t> _head;
+    // Keeps both indices on separate cache lines to avoid false sharing between the threads.
+    char _padding[64];
+    std::atomic<std::size_t> _tail;
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,238 @@
+#include "tone.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define EZ_TONE_SSE2
+#endif
+
+#include "parallel.h"
+
+namespace {
+
+/*! The number of columns processed by a single task of the vertical blur. */
+int const BlurStripWidth{64};
+
+/*! The largest supported sharpening amount, limited by the 16-bit fixed point arithmetic. */
+double const MaximumSharpenAmount{7.9};
+
+void boxBlurHorizontal(QImage& image, int radius) {
+    auto const width = image.width();
+    int const reciprocal{65536 / (2*radius + 1)};
+    Parallel::forEachBand(image.height(), [&image, width, radius, reciprocal](int first, int last) {
+        std::vector<uchar> source(width);
+        for(int y{first}; y < last; ++y) {
+            auto line = image.scanLine(y);
+            std::copy(line, line + width, source.begin());
+
+            int sum{(radius + 1) * source[0]};
+            for(int i{1}; i <= radius; ++i) {
+                sum += source[std::min(i, width - 1)];
+            }
+            for(int x{0}; x < width; ++x) {
+                line[x] = static_cast<uchar>((sum * reciprocal + 0x8000) >> 16);
+                sum += source[std::min(x + radius + 1, width - 1)] - source[std::max(x - radius, 0)];
+            }
+        }
+    });
+}
+
+void boxBlurVertical(QImage& image, int radius) {
+    auto const source = image.copy();
+    auto const width = image.width();
+    auto const height = image.height();
+    int const reciprocal{65536 / (2*radius + 1)};
+    auto const strips = (width + BlurStripWidth - 1) / BlurStripWidth;
+
+    // Columns are processed in strips, which keeps the inner loops running along a row.
+    // A strip spans the whole height, so every strip is worth a task of its own.
+    Parallel::forEachBand(strips, 1, [&](int firstStrip, int lastStrip) {
+        auto const x0 = firstStrip * BlurStripWidth;
+        auto const count = std::min(width, lastStrip * BlurStripWidth) - x0;
+        std::vector<int> sum(count);
+
+        auto row = [&source, x0](int y) { return source.constScanLine(y) + x0; };
+        auto top = row(0);
+        for(int x{0}; x < count; ++x) {
+            sum[x] = (radius + 1) * top[x];
+        }
+        for(int i{1}; i <= radius; ++i) {
+            auto line = row(std::min(i, height - 1));
+            for(int x{0}; x < count; ++x) {
+                sum[x] += line[x];
+            }
+        }
+
+        for(int y{0}; y < height; ++y) {
+            auto target = image.scanLine(y) + x0;
+            for(int x{0}; x < count; ++x) {
+                target[x] = static_cast<uchar>((sum[x] * reciprocal + 0x8000) >> 16);
+            }
+            auto entering = row(std::min(y + radius + 1, height - 1));
+            auto leaving = row(std::max(y - radius, 0));
+            for(int x{0}; x < count; ++x) {
+                sum[x] += entering[x] - leaving[x];
+            }
+        }
+    });
+}
+
+}
+
+bool ToneSettings::isIdentity() const {
+    ToneSettings const defaults{};
+    return brightness == 0 && contrast == 0 && qFuzzyCompare(gamma, 1.0) && !autoLevels && sharpenAmount <= 0
+            && qFuzzyCompare(redWeight, defaults.redWeight)
+            && qFuzzyCompare(greenWeight, defaults.greenWeight)
+            && qFuzzyCompare(blueWeight, defaults.blueWeight);
+}
+
+bool ToneSettings::operator==(ToneSettings const& other) const {
+    return brightness == other.brightness && contrast == other.contrast && gamma == other.gamma
+            && autoLevels == other.autoLevels && redWeight == other.redWeight && greenWeight == other.greenWeight
+            && blueWeight == other.blueWeight && sharpenAmount == other.sharpenAmount && sharpenRadius == other.sharpenRadius;
+}
+
+bool ToneSettings::operator!=(ToneSettings const& other) const {
+    return !(*this == other);
+}
+
+QImage Tone::apply(QImage const& image, ToneSettings const& settings) {
+    auto gray = grayscale(image, settings);
+
+    int low{0}, high{255};
+    if(settings.autoLevels) {
+        auto const counts = histogram(gray);
+        auto const clip = static_cast<int>(gray.width() * gray.height() * AutoLevelsClip);
+        for(int sum{0}; low < 255 && (sum += counts[low]) <= clip; ++low) {}
+        for(int sum{0}; high > 0 && (sum += counts[high]) <= clip; --high) {}
+        if(high <= low) {
+            low = 0;
+            high = 255;
+        }
+    }
+
+    auto const table = lookupTable(settings, low, high);
+    auto const width = gray.width();
+    Parallel::forEachBand(gray.height(), [&gray, &table, width](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto line = gray.scanLine(y);
+            for(int x{0}; x < width; ++x) {
+                line[x] = table[line[x]];
+            }
+        }
+    });
+
+    if(settings.sharpenAmount > 0) {
+        unsharpMask(gray, settings.sharpenAmount, settings.sharpenRadius);
+    }
+    return gray;
+}
+
+QImage Tone::grayscale(QImage const& image, ToneSettings const& settings) {
+    auto const source = image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32
+            ? image : image.convertToFormat(QImage::Format_RGB32);
+
+    // 8-bit fixed point weights, normalized to a sum of 256.
+    auto total = std::max(1e-6, settings.redWeight + settings.greenWeight + settings.blueWeight);
+    int const red{qRound(std::max(0.0, settings.redWeight) / total * 256)};
+    int const blue{qRound(std::max(0.0, settings.blueWeight) / total * 256)};
+    int const green{std::max(0, 256 - red - blue)};
+
+    QImage gray{source.size(), QImage::Format_Grayscale8};
+    auto const width = source.width();
+    Parallel::forEachBand(source.height(), [&](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto in = reinterpret_cast<QRgb const*>(source.constScanLine(y));
+            auto out = gray.scanLine(y);
+            for(int x{0}; x < width; ++x) {
+                auto const value = (qRed(in[x]) * red + qGreen(in[x]) * green + qBlue(in[x]) * blue) >> 8;
+                out[x] = static_cast<uchar>(std::min(value, 255));
+            }
+        }
+    });
+    return gray;
+}
+
+std::array<int, 256> Tone::histogram(QImage const& image) {
+    std::array<int, 256> counts{};
+    QMutex mutex{};
+    auto const width = image.width();
+    Parallel::forEachBand(image.height(), [&](int first, int last) {
+        std::array<int, 256> local{};
+        for(int y{first}; y < last; ++y) {
+            auto line = image.constScanLine(y);
+            for(int x{0}; x < width; ++x) {
+                ++local[line[x]];
+            }
+        }
+
+        QMutexLocker locker{&mutex};
+        std::transform(counts.begin(), counts.end(), local.begin(), counts.begin(), std::plus<int>{});
+    });
+    return counts;
+}
+
+std::array<uchar, 256> Tone::lookupTable(ToneSettings const& settings, int low, int high) {
+    std::array<uchar, 256> table{};
+    auto const range = std::max(1, high - low);
+    auto const contrast = (100.0 + qBound(-100, settings.contrast, 100)) / 100.0;
+    auto const exponent = 1.0 / std::max(0.01, settings.gamma);
+    for(int i{0}; i < 256; ++i) {
+        auto value = qBound(0.0, (i - low) * 255.0 / range, 255.0);
+        value = qBound(0.0, (value - 127.5) * contrast + 127.5 + settings.brightness, 255.0);
+        value = 255.0 * std::pow(value / 255.0, exponent);
+        table[i] = static_cast<uchar>(qBound(0, qRound(value), 255));
+    }
+    return table;
+}
+
+void Tone::unsharpMask(QImage& image, double amount, int radius) {
+    auto blurred = image.copy();
+    blur(blurred, radius);
+
+    // Amount as 4-bit fixed point, the products then fit into signed 16-bit lanes.
+    int const factor{qRound(qBound(0.0, amount, MaximumSharpenAmount) * 16)};
+    auto const width = image.width();
+    Parallel::forEachBand(image.height(), [&image, &blurred, factor, width](int first, int last) {
+        for(int y{first}; y < last; ++y) {
+            auto line = image.scanLine(y);
+            auto soft = blurred.constScanLine(y);
+            int x{0};
+#ifdef EZ_TONE_SSE2
+            auto const zero = _mm_setzero_si128();
+            auto const weight = _mm_set1_epi16(static_cast<short>(factor));
+            for(; x + 16 <= width; x += 16) {
+                auto const in = _mm_loadu_si128(reinterpret_cast<__m128i const*>(line + x));
+                auto const smooth = _mm_loadu_si128(reinterpret_cast<__m128i const*>(soft + x));
+                auto const inLow = _mm_unpacklo_epi8(in, zero);
+                auto const inHigh = _mm_unpackhi_epi8(in, zero);
+                auto const low = _mm_add_epi16(inLow, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(inLow, _mm_unpacklo_epi8(smooth, zero)), weight), 4));
+                auto const high = _mm_add_epi16(inHigh, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(inHigh, _mm_unpackhi_epi8(smooth, zero)), weight), 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(line + x), _mm_packus_epi16(low, high));
+            }
+#endif
+            for(; x < width; ++x) {
+                auto const value = line[x] + (((line[x] - soft[x]) * factor) >> 4);
+                line[x] = static_cast<uchar>(qBound(0, value, 255));
+            }
+        }
+    });
+}
+
+void Tone::blur(QImage& image, int radius) {
+    if(radius < 1) {
+        return;
+    }
+    for(int pass{0}; pass < 2; ++pass) {
+        boxBlurHorizontal(image, radius);
+        boxBlurVertical(image, radius);
+    }
+}
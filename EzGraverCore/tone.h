@@ -0,0 +1,119 @@
+#ifndef TONE_H
+#define TONE_H
+
+#include "ezgravercore_global.h"
+
+#include <QImage>
+#include <QMetaType>
+
+#include <array>
+
+/*!
+ * The settings of the tone adjustment applied before an image is binarized.
+ */
+struct EZGRAVERCORESHARED_EXPORT ToneSettings {
+    /*! The brightness offset in the range -255 to 255. */
+    int brightness{0};
+
+    /*! The contrast change in percent in the range -100 to 100. */
+    int contrast{0};
+
+    /*! The gamma correction, \c 1 keeps the tones. */
+    double gamma{1.0};
+
+    /*! \c true if the histogram should be stretched to the full range. */
+    bool autoLevels{false};
+
+    /*! The weight of the red channel used for the grayscale conversion. */
+    double redWeight{0.299};
+
+    /*! The weight of the green channel used for the grayscale conversion. */
+    double greenWeight{0.587};
+
+    /*! The weight of the blue channel used for the grayscale conversion. */
+    double blueWeight{0.114};
+
+    /*! The amount of the unsharp mask, \c 0 disables sharpening. */
+    double sharpenAmount{0.0};
+
+    /*! The radius of the unsharp mask in pixels. */
+    int sharpenRadius{2};
+
+    /*!
+     * Checks if the settings leave the image unchanged, i.e. no tone stage is required.
+     *
+     * \return \c true if no adjustment is configured.
+     */
+    bool isIdentity() const;
+
+    bool operator==(ToneSettings const& other) const;
+    bool operator!=(ToneSettings const& other) const;
+};
+
+Q_DECLARE_METATYPE(ToneSettings)
+
+/*!
+ * The tone adjustment stage. All operations work on 8-bit grayscale images and are
+ * processed in parallel bands; the inner loops are kept branch free to allow the
+ * compiler to vectorize them, the unsharp mask uses SSE2 where available.
+ */
+struct EZGRAVERCORESHARED_EXPORT Tone {
+    /*! The fraction of pixels clipped on each side by the automatic levels. */
+    static constexpr double AutoLevelsClip{0.005};
+
+    /*!
+     * Applies the given tone \a settings to the \a image.
+     *
+     * \param image The image to adjust, transparency should already be composed.
+     * \param settings The adjustment to apply.
+     * \return The adjusted image in the format \c QImage::Format_Grayscale8.
+     */
+    static QImage apply(QImage const& image, ToneSettings const& settings);
+
+    /*!
+     * Converts the given \a image to grayscale using the channel mixer of the \a settings.
+     *
+     * \param image The image to convert.
+     * \param settings The settings containing the channel weights.
+     * \return The image in the format \c QImage::Format_Grayscale8.
+     */
+    static QImage grayscale(QImage const& image, ToneSettings const& settings);
+
+    /*!
+     * Computes the histogram of the given grayscale \a image.
+     *
+     * \param image The image in the format \c QImage::Format_Grayscale8.
+     * \return The number of pixels per gray value.
+     */
+    static std::array<int, 256> histogram(QImage const& image);
+
+    /*!
+     * Creates the lookup table combining levels, brightness, contrast and gamma.
+     *
+     * \param settings The adjustment to apply.
+     * \param low The gray value mapped to black.
+     * \param high The gray value mapped to white.
+     * \return The lookup table.
+     */
+    static std::array<uchar, 256> lookupTable(ToneSettings const& settings, int low=0, int high=255);
+
+    /*!
+     * Sharpens the given grayscale \a image in place using an unsharp mask.
+     *
+     * \param image The image in the format \c QImage::Format_Grayscale8.
+     * \param amount The strength of the sharpening.
+     * \param radius The radius of the blur in pixels.
+     */
+    static void unsharpMask(QImage& image, double amount, int radius);
+
+    /*!
+     * Blurs the given grayscale \a image in place by applying a box blur twice, which
+     * approximates a gaussian blur.
+     *
+     * \param image The image in the format \c QImage::Format_Grayscale8.
+     * \param radius The radius of the box in pixels.
+     */
+    static void blur(QImage& image, int radius);
+};
+
+#endif // TONE_H
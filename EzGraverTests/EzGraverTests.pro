@@ -0,0 +1,23 @@
+include(../common.pri)
+
+QT += core
+QT += gui
+QT += serialport
+QT += concurrent
+QT += svg
+QT += testlib
+
+TARGET = EzGraverTests
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES += imageloadertest.cpp
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../EzGraverCore/release/ -lEzGraverCore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../EzGraverCore/debug/ -lEzGraverCore
+else:unix: LIBS += -L$$OUT_PWD/../EzGraverCore/ -lEzGraverCore
+
+INCLUDEPATH += $$PWD/../EzGraverCore
+DEPENDPATH += $$PWD/../EzGraverCore
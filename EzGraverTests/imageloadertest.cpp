@@ -0,0 +1,52 @@
+#include <QGuiApplication>
+#include <QTemporaryFile>
+#include <QDir>
+#include <QtTest>
+
+#include "imageloader.h"
+#include "ezgraver.h"
+
+namespace {
+
+/*! A vector image consisting of text only, rendered through the font database. */
+char const TextSvg[]{
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"200\" height=\"100\">"
+    "<text x=\"10\" y=\"60\" font-family=\"sans-serif\" font-size=\"40\">EzGraver</text>"
+    "</svg>"};
+
+}
+
+class ImageLoaderTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void rendersSvgTextFromFile();
+    void rendersSvgTextFromData();
+};
+
+void ImageLoaderTest::rendersSvgTextFromFile() {
+    QTemporaryFile file{QDir::temp().filePath("XXXXXX.svg")};
+    QVERIFY(file.open());
+    file.write(TextSvg);
+    file.close();
+
+    auto image = ImageLoader::load(file.fileName());
+    QVERIFY(!image.isNull());
+    QCOMPARE(image.size(), QSize(EzGraver::ImageWidth, EzGraver::ImageHeight / 2));
+}
+
+void ImageLoaderTest::rendersSvgTextFromData() {
+    auto image = ImageLoader::load(QByteArray{TextSvg});
+    QVERIFY(!image.isNull());
+    QCOMPARE(image.size(), QSize(EzGraver::ImageWidth, EzGraver::ImageHeight / 2));
+}
+
+int main(int argc, char* argv[]) {
+    // Runs headless just like the command line tools do.
+    ImageLoader::useOffscreenPlatform();
+    QGuiApplication app{argc, argv};
+    ImageLoaderTest test{};
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "imageloadertest.moc"
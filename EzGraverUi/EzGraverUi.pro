@@ -3,6 +3,8 @@ include(../common.pri)
 QT += core
 QT += gui
 QT += serialport
+QT += concurrent
+QT += svg
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -13,11 +15,21 @@ TEMPLATE = app
 SOURCES += main.cpp\
         mainwindow.cpp \
     clicklabel.cpp \
-    imagelabel.cpp
+    imagelabel.cpp \
+    imagepyramid.cpp \
+    comparedialog.cpp \
+    telemetrywidget.cpp \
+    telemetrydialog.cpp \
+    nestdialog.cpp
 
 HEADERS  += mainwindow.h \
     clicklabel.h \
-    imagelabel.h
+    imagelabel.h \
+    imagepyramid.h \
+    comparedialog.h \
+    telemetrywidget.h \
+    telemetrydialog.h \
+    nestdialog.h
 
 FORMS    += mainwindow.ui
 
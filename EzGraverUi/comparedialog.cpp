@@ -0,0 +1,63 @@
+#include "comparedialog.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QGridLayout>
+#include <QVBoxLayout>
+#include <QToolButton>
+#include <QLabel>
+
+#include <algorithm>
+
+CompareDialog::CompareDialog(QImage const& image, EdgeSettings const& edges, ThresholdSettings const& threshold,
+                             QWidget* parent)
+    : QDialog{parent}, _grid{new QGridLayout{}}, _status{new QLabel{"Rendering candidates..."}}, _watcher{}, _selected{} {
+    setWindowTitle("Compare Conversions");
+
+    auto layout = new QVBoxLayout{this};
+    layout->addWidget(_status);
+    layout->addLayout(_grid);
+
+    connect(&_watcher, &QFutureWatcher<QVector<Candidate>>::finished, [this] { _showCandidates(_watcher.result()); });
+    _watcher.setFuture(QtConcurrent::run([image, edges, threshold] {
+        auto candidates = Comparison::defaultCandidates(edges, threshold);
+        Comparison::evaluate(image, candidates);
+        return candidates;
+    }));
+}
+
+CompareDialog::~CompareDialog() {
+    _watcher.waitForFinished();
+}
+
+Candidate CompareDialog::selected() const {
+    return _selected;
+}
+
+void CompareDialog::_showCandidates(QVector<Candidate> const& candidates) {
+    _status->setText("Choose a conversion. Highlighted candidates are not beaten in both quality and burned pixels.");
+
+    for(int i{0}; i < candidates.size(); ++i) {
+        auto const& candidate = candidates[i];
+
+        // A candidate is a sensible trade-off unless another one is at least as good in both scores.
+        auto dominated = std::any_of(candidates.begin(), candidates.end(), [&candidate](Candidate const& other) {
+            return other.similarity >= candidate.similarity && other.burnCount <= candidate.burnCount
+                    && (other.similarity > candidate.similarity || other.burnCount < candidate.burnCount);
+        });
+
+        auto button = new QToolButton{};
+        button->setToolButtonStyle(Qt::ToolButtonTextUnderIcon);
+        button->setIconSize(QSize{ThumbnailSize, ThumbnailSize});
+        button->setIcon(QPixmap::fromImage(candidate.raster.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
+        button->setText(QString{"%1\nSSIM %2, %3 px"}.arg(candidate.name).arg(candidate.similarity, 0, 'f', 3).arg(candidate.burnCount));
+        if(!dominated) {
+            button->setStyleSheet("font-weight: bold");
+        }
+
+        connect(button, &QToolButton::clicked, [this, candidate] {
+            _selected = candidate;
+            accept();
+        });
+        _grid->addWidget(button, i / Columns, i % Columns);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef COMPAREDIALOG_H
+#define COMPAREDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QVector>
+
+#include "comparison.h"
+
+class QGridLayout;
+class QLabel;
+
+/*!
+ * Shows all conversion candidates of an image side by side, rendered concurrently and
+ * scored by their similarity to the source and their number of burned pixels.
+ */
+class CompareDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    /*! The size of the previews in pixels. */
+    static int const ThumbnailSize{192};
+
+    /*! The number of previews per row. */
+    static int const Columns{3};
+
+    /*!
+     * Creates a new dialog and starts rendering the candidates.
+     *
+     * \param image The image as it is passed to the binarization.
+     * \param edges The settings of the edge detection.
+     * \param threshold The settings of the adaptive threshold.
+     * \param parent The parent of the dialog.
+     */
+    explicit CompareDialog(QImage const& image, EdgeSettings const& edges, ThresholdSettings const& threshold,
+                           QWidget* parent=NULL);
+
+    /*!
+     * Waits for the rendering to finish upon deconstruction.
+     */
+    virtual ~CompareDialog();
+
+    /*!
+     * Gets the candidate chosen by the user.
+     *
+     * \return The chosen candidate, only valid if the dialog has been accepted.
+     */
+    Candidate selected() const;
+
+private:
+    QGridLayout* _grid;
+    QLabel* _status;
+    QFutureWatcher<QVector<Candidate>> _watcher;
+    Candidate _selected;
+
+    void _showCandidates(QVector<Candidate> const& candidates);
+};
+
+#endif // COMPAREDIALOG_H
@@ -1,47 +1,202 @@
 #include "imagelabel.h"
 
 #include <QPainter>
+#include <QDataStream>
+#include <QApplication>
+#include <QPaintEvent>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QDebug>
 
 #include <algorithm>
+#include <cmath>
 
 #include "ezgraver.h"
+#include "bitmapstats.h"
+#include "imageloader.h"
+
+namespace {
+
+/*! Part of every cache key, to be changed whenever the processing pipeline changes its output. */
+qint32 const PipelineVersion{1};
+
+/*! The factor a single step of the mouse wheel zooms by. */
+double const ZoomStep{1.25};
+
+/*! The largest zoom factor relative to the fitted image. */
+double const MaximumZoom{32.0};
+
+/*! The time the conversion settings have to stay unchanged before the bitmap is cached. */
+int const CacheStoreDelay{1000};
+
+}
 
 ImageLabel::ImageLabel(QWidget* parent)
     : ClickLabel{parent}
     , _image{}
+    , _fileName{}
+    , _sourceHash{}
+    , _cache{}
+    , _cacheTimer{}
+    , _cacheStore{}
+    , _cacheKeyPending{}
+    , _cacheBitmap{}
+    , _cacheStats{0, QRect{}, 0, 0}
+    , _converted{false}
     , _layerBurn{QSize{EzGraver::ImageWidth, EzGraver::ImageHeight}, QImage::Format_ARGB32}
-    , _flags{Qt::DiffuseDither}
+    , _binarizer{}
     , _grayscale{false}
     , _layer{0}
     , _layerCount{3}
     , _keepAspectRatio{false}
-{   }
+    , _tone{}
+    , _budget{}
+    , _estimator{}
+    , _filters{}
+    , _stats{0, QRect{}, 0, 0}
+    , _burnDirty{}
+    , _rasterPyramid{}
+    , _sourcePyramid{}
+    , _material{}
+    , _center{EzGraver::ImageWidth / 2.0, EzGraver::ImageHeight / 2.0}
+    , _pressPosition{}
+    , _pressCenter{}
+{
+    _layerBurn.fill(qRgba(0, 0, 0, 0));
+
+    _cacheTimer.setSingleShot(true);
+    _cacheTimer.setInterval(CacheStoreDelay);
+    connect(&_cacheTimer, &QTimer::timeout, this, &ImageLabel::_storeCached);
+}
 
-ImageLabel::~ImageLabel() {}
+ImageLabel::~ImageLabel() {
+    _cacheStore.waitForFinished();
+}
 
 QImage ImageLabel::image() const {
+    _decodeImage();
     return _image;
 }
 
 void ImageLabel::setImage(QImage const& image) {
+    _fileName.clear();
+    _sourceHash.clear();
+    _converted = false;
+    _assignImage(image);
+}
+
+void ImageLabel::setRaster(QImage const& raster) {
+    _fileName.clear();
+    _sourceHash.clear();
+    _converted = true;
+    _assignImage(raster.convertToFormat(QImage::Format_Mono).scaled(EzGraver::ImageWidth, EzGraver::ImageHeight));
+}
+
+bool ImageLabel::loadImage(QString const& fileName) {
+    auto const sourceHash = BitmapCache::hashFile(fileName);
+    if(sourceHash.isEmpty()) {
+        return false;
+    }
+
+    // The image only has to be decoded right away if the cache cannot provide its bitmap.
+    QImage image{};
+    if(!_cache.contains(_cacheKey(sourceHash))) {
+        image = ImageLoader::load(fileName);
+        if(image.isNull()) {
+            return false;
+        }
+    }
+
+    _fileName = fileName;
+    _sourceHash = sourceHash;
+    _converted = false;
+    _assignImage(image);
+    return true;
+}
+
+void ImageLabel::_assignImage(QImage const& image) {
     _image = image;
+    _composed = QImage{};
+    _sourcePyramid.setImage(QImage{});
+    resetZoom();
     _burnCount = _burnedCount = 0;
     updateDisplayedImage();
     emit imageLoadedChanged(true);
     emit imageChanged(image);
 }
 
+bool ImageLabel::_decodeImage() const {
+    if(_image.isNull() && !_fileName.isEmpty()) {
+        qDebug() << "decoding image" << _fileName;
+        _image = ImageLoader::load(_fileName);
+    }
+    return !_image.isNull();
+}
+
+QByteArray ImageLabel::_cacheKey(QByteArray const& sourceHash) const {
+    // Layered grayscale images without a selected layer do not result in a bitmap, budgets depend on the calibration.
+    if(sourceHash.isEmpty() || (_grayscale && _layer == 0) || (!_grayscale && _budget.isActive())) {
+        return QByteArray{};
+    }
+
+    QByteArray parameters{};
+    QDataStream stream{&parameters, QIODevice::WriteOnly};
+    stream << PipelineVersion
+           << static_cast<qint32>(_binarizer.mode) << static_cast<qint32>(_binarizer.flags)
+           << _binarizer.edges.sigma << static_cast<qint32>(_binarizer.edges.lowThreshold)
+           << static_cast<qint32>(_binarizer.edges.highThreshold)
+           << static_cast<qint32>(_binarizer.threshold.window) << _binarizer.threshold.k
+           << _grayscale << static_cast<qint32>(_layer) << static_cast<qint32>(_layerCount) << _keepAspectRatio
+           << static_cast<qint32>(_tone.brightness) << static_cast<qint32>(_tone.contrast) << _tone.gamma
+           << _tone.autoLevels << _tone.redWeight << _tone.greenWeight << _tone.blueWeight
+           << _tone.sharpenAmount << static_cast<qint32>(_tone.sharpenRadius);
+    if(_filtersEnabled && !_filters.isEmpty()) {
+        stream << _filters.signature();
+    }
+    return BitmapCache::key(sourceHash, parameters);
+}
+
 Qt::ImageConversionFlags ImageLabel::conversionFlags() const {
-    return _flags;
+    return _binarizer.flags;
 }
 
 void ImageLabel::setConversionFlags(Qt::ImageConversionFlags const& flags) {
-    _flags = flags;
+    _binarizer.flags = flags;
     updateDisplayedImage();
     emit conversionFlagsChanged(flags);
 }
 
+BinarizerSettings::Mode ImageLabel::conversionMode() const {
+    return _binarizer.mode;
+}
+
+void ImageLabel::setConversionMode(BinarizerSettings::Mode const& mode) {
+    _binarizer.mode = mode;
+    updateDisplayedImage();
+    emit conversionModeChanged(mode);
+}
+
+EdgeSettings ImageLabel::edgeSettings() const {
+    return _binarizer.edges;
+}
+
+void ImageLabel::setEdgeSettings(EdgeSettings const& edgeSettings) {
+    _binarizer.edges = edgeSettings;
+    updateDisplayedImage();
+    emit edgeSettingsChanged(edgeSettings);
+}
+
+ThresholdSettings ImageLabel::thresholdSettings() const {
+    return _binarizer.threshold;
+}
+
+void ImageLabel::setThresholdSettings(ThresholdSettings const& thresholdSettings) {
+    _binarizer.threshold = thresholdSettings;
+    updateDisplayedImage();
+    emit thresholdSettingsChanged(thresholdSettings);
+}
+
 bool ImageLabel::grayscale() const {
     return _grayscale;
 }
@@ -78,15 +233,105 @@ bool ImageLabel::keepAspectRatio() const {
 
 void ImageLabel::setKeepAspectRatio(bool const& keepAspectRatio) {
     _keepAspectRatio = keepAspectRatio;
+    _composed = QImage{};
     updateDisplayedImage();
     emit keepAspectRatioChanged(keepAspectRatio);
 }
 
+ToneSettings ImageLabel::tone() const {
+    return _tone;
+}
+
+void ImageLabel::setTone(ToneSettings const& tone) {
+    _tone = tone;
+    updateDisplayedImage();
+    emit toneChanged(tone);
+}
+
 void ImageLabel::updateDisplayedImage() {
     if(!imageLoaded()) {
         return;
     }
 
+    auto const key = _cacheKey(_sourceHash);
+    BitmapStats stats{};
+    _budgetOffset = 0;
+    _budgetMet = true;
+    if(_converted) {
+        // Already converted rasters are shown and uploaded as they are.
+        _displayImg = _image;
+        _bitmap = EzGraver::convertImage(_displayImg);
+        stats = BitmapStats::analyze(_bitmap);
+    } else if(_image.isNull() && _cache.lookup(key, _bitmap, stats)) {
+        // The cache is only consulted as long as the source has not been decoded, converting
+        // it in memory is cheaper than reading the disk on every change of the settings.
+        // The displayed image is the device bitmap mirrored back, with black pixels being burned.
+        _displayImg = _bitmap.mirrored();
+        _displayImg.invertPixels();
+    } else {
+        if(!_decodeImage()) {
+            qDebug() << "failed to decode image" << _fileName;
+            return;
+        }
+        if(_composed.isNull()) {
+            _composeImage();
+        }
+
+        // Only the tone stage, the filters and the binarization are repeated while the image stays the same.
+        auto image = _preprocessImage();
+        if(_grayscale) {
+            _displayImg = _createGrayscaleImage(image);
+        } else if(_budget.isActive()) {
+            auto const result = Budget::fit(image, _binarizer, _budget, _estimator);
+            _displayImg = result.raster;
+            _budgetOffset = result.offset;
+            _budgetMet = result.fits;
+        } else {
+            _displayImg = Binarizer::apply(image, _binarizer);
+        }
+        _bitmap = _displayImg.format() == QImage::Format_Mono ? EzGraver::convertImage(_displayImg) : QImage{};
+        stats = BitmapStats::analyze(_bitmap);
+        if(!key.isEmpty() && !_bitmap.isNull()) {
+            // Only settings left unchanged for a while are cached, not every step of a slider.
+            _cacheKeyPending = key;
+            _cacheBitmap = _bitmap;
+            _cacheStats = stats;
+            _cacheTimer.start();
+        }
+    }
+
+    _stats = stats;
+    updateDimensions(stats);
+    _updateRaster();
+    emit bitmapChanged();
+}
+
+void ImageLabel::_updateRaster() {
+    if(_simulated && _displayImg.format() == QImage::Format_Mono) {
+        _rasterPyramid.setImage(BurnSimulator::simulate(_displayImg, _material, _simulatedBurnTime));
+    } else {
+        _rasterPyramid.setImage(_displayImg);
+    }
+    update();
+}
+
+void ImageLabel::_storeCached() {
+    if(_cacheStore.isRunning()) {
+        _cacheTimer.start();
+        return;
+    }
+
+    auto const key = _cacheKeyPending;
+    auto const bitmap = _cacheBitmap;
+    auto const stats = _cacheStats;
+    _cacheKeyPending.clear();
+    _cacheBitmap = QImage{};
+    _cacheStore = QtConcurrent::run([this, key, bitmap, stats] {
+        _cache.store(key, bitmap, stats);
+    });
+}
+
+void ImageLabel::_composeImage() {
     // Draw white background, otherwise transparency is converted to black.
     QImage image{QSize{EzGraver::ImageWidth, EzGraver::ImageHeight}, QImage::Format_ARGB32};
     image.fill(QColor{Qt::white});
@@ -100,14 +345,14 @@ void ImageLabel::updateDisplayedImage() {
             ? (_image.width() > _image.height() ? QPoint(0, (image.height() - scaled.height()) / 2) : QPoint((image.width() - scaled.width()) / 2, 0))
             : QPoint(0, 0);
     painter.drawImage(position, scaled);
+    painter.end();
 
-    _displayImg = _grayscale ? _createGrayscaleImage(image) : image.convertToFormat(QImage::Format_Mono, _flags);
-    updateInfoLayers();
+    _composed = image;
 }
 
 QImage ImageLabel::_createGrayscaleImage(QImage const& original) const {
     auto colorTable = _createColorTable();
-    QImage grayed = original.convertToFormat(QImage::Format_Indexed8, colorTable, _flags);
+    QImage grayed = original.convertToFormat(QImage::Format_Indexed8, colorTable, _binarizer.flags);
     if(_layer == 0) {
         return grayed;
     }
@@ -119,7 +364,7 @@ QImage ImageLabel::_createGrayscaleImage(QImage const& original) const {
     });
     grayed.setColorTable(colorTable);
 
-    return grayed.convertToFormat(QImage::Format_Mono, _flags);
+    return grayed.convertToFormat(QImage::Format_Mono, _binarizer.flags);
 }
 
 QVector<QRgb> ImageLabel::_createColorTable() const {
@@ -135,8 +380,43 @@ QVector<QRgb> ImageLabel::_createColorTable() const {
     return colorTable;
 }
 
+BudgetSettings ImageLabel::budget() const {
+    return _budget;
+}
+
+void ImageLabel::setBudget(BudgetSettings const& budget) {
+    _budget = budget;
+    updateDisplayedImage();
+    emit budgetChanged(budget);
+}
+
+int ImageLabel::budgetOffset() const {
+    return _budgetOffset;
+}
+
+bool ImageLabel::budgetMet() const {
+    return _budgetMet;
+}
+
+DurationEstimator& ImageLabel::estimator() {
+    return _estimator;
+}
+
+FilterPipeline& ImageLabel::filters() {
+    return _filters;
+}
+
+bool ImageLabel::filtersEnabled() const {
+    return _filtersEnabled;
+}
+
+void ImageLabel::setFiltersEnabled(bool enabled) {
+    _filtersEnabled = enabled;
+    updateDisplayedImage();
+}
+
 bool ImageLabel::imageLoaded() const {
-    return !_image.isNull();
+    return !_image.isNull() || !_fileName.isEmpty();
 }
 
 void ImageLabel::setImageDimensions(QSize const& dimensions) {
@@ -162,46 +442,215 @@ int ImageLabel::picH() const {
 }
 
 int ImageLabel::markBurnedPixel(int x, int y) {
-    _layerBurn.setPixel(x, y, qRgba(0xFF, 0x00, 0x00, 0xFF));
-    updateDisplayedImage();
+    if(_layerBurn.valid(x, y)) {
+        _layerBurn.setPixel(x, y, qRgba(0xFF, 0x00, 0x00, 0xFF));
+        _burnDirty |= QRect{x, y, 1, 1};
+    }
     return ++_burnedCount;
 }
 
 void ImageLabel::resetBurnStatus() {
     _layerBurn.fill(qRgba(0, 0, 0, 0));
+    _burnDirty = QRect{};
     _burnedCount = 0;
     updateDisplayedImage();
 }
 
-void ImageLabel::updateDimensions(QImage const & image) {
-    // _picY0 = _picY1 = _picX0 = _picX1 = -1;
-    auto const w = image.width();
-    auto const h = image.height();
-    _picX0 = w;
-    _picY0 = h;
-    _picX1 = 0;
-    _picY1 = 0;
-    _burnCount = 0;
-    for (int y = 0; y < h; ++y)
-        for (int x = 0; x < w; ++x)
-        {
-            if (image.pixel(x, y) == qRgba(0, 0, 0, 0xFF))
-            {
-                ++_burnCount;
-                _picX0 = std::min(_picX0, x);
-                _picY0 = std::min(_picY0, y);
-                _picX1 = std::max(_picX1, x);
-                _picY1 = std::max(_picY1, y);
-            }
-        }
+QImage ImageLabel::adjustedImage() {
+    if(!_decodeImage()) {
+        return QImage{};
+    }
+    if(_composed.isNull()) {
+        _composeImage();
+    }
+    return _preprocessImage();
+}
+
+QImage ImageLabel::_preprocessImage() const {
+    auto const image = _tone.isIdentity() ? _composed : Tone::apply(_composed, _tone);
+    return _filtersEnabled ? _filters.apply(image) : image;
+}
+
+QImage ImageLabel::bitmap() const {
+    return _bitmap;
+}
+
+BitmapStats ImageLabel::stats() const {
+    return _stats;
+}
+
+void ImageLabel::updateDimensions(BitmapStats const& stats) {
+    _burnCount = stats.burnCount;
+    if(stats.bounds.isEmpty()) {
+        _picX0 = EzGraver::ImageWidth;
+        _picY0 = EzGraver::ImageHeight;
+        _picX1 = 0;
+        _picY1 = 0;
+        return;
+    }
+
+    // The bitmap is mirrored vertically compared to the displayed image.
+    _picX0 = stats.bounds.left();
+    _picX1 = stats.bounds.right();
+    _picY0 = EzGraver::ImageHeight - 1 - stats.bounds.bottom();
+    _picY1 = EzGraver::ImageHeight - 1 - stats.bounds.top();
 }
 
 void ImageLabel::updateInfoLayers() {
-    auto img = _displayImg.convertToFormat(QImage::Format_ARGB32, 0);
-    QPainter painter{&img};
-    painter.drawImage(QPoint(0, 0), _layerBurn);
-
-    auto rendered = QPixmap::fromImage(img);
-    setPixmap(rendered);
-    updateDimensions(img);
-}
\ No newline at end of file
+    if(_burnDirty.isEmpty()) {
+        return;
+    }
+
+    auto const canvas = _canvasTarget();
+    auto const scale = _scale();
+    QRectF area{canvas.left() + _burnDirty.left() * scale, canvas.top() + _burnDirty.top() * scale,
+                _burnDirty.width() * scale, _burnDirty.height() * scale};
+    update(area.toAlignedRect().adjusted(-1, -1, 1, 1));
+    _burnDirty = QRect{};
+}
+
+bool ImageLabel::showSource() const {
+    return _showSource;
+}
+
+void ImageLabel::setShowSource(bool showSource) {
+    _showSource = showSource;
+    update();
+    emit showSourceChanged(showSource);
+}
+
+bool ImageLabel::simulated() const {
+    return _simulated;
+}
+
+void ImageLabel::setSimulation(bool enabled, MaterialProfile const& material, int burnTime) {
+    auto const changed = enabled || _simulated;
+    _simulated = enabled;
+    _material = material;
+    _simulatedBurnTime = burnTime;
+    if(changed && !_displayImg.isNull()) {
+        _updateRaster();
+    }
+}
+
+double ImageLabel::zoom() const {
+    return _zoom;
+}
+
+void ImageLabel::resetZoom() {
+    _setView(1.0, QPointF{EzGraver::ImageWidth / 2.0, EzGraver::ImageHeight / 2.0});
+}
+
+QRectF ImageLabel::_sourceArea() const {
+    // Matches the placement of the source image onto the canvas by _composeImage.
+    QSizeF const canvas{EzGraver::ImageWidth, EzGraver::ImageHeight};
+    if(!_keepAspectRatio || _sourcePyramid.isNull()) {
+        return QRectF{QPointF{0, 0}, canvas};
+    }
+
+    auto const size = QSizeF{_sourcePyramid.size()}.scaled(canvas, Qt::KeepAspectRatio);
+    return QRectF{QPointF{(canvas.width() - size.width()) / 2, (canvas.height() - size.height()) / 2}, size};
+}
+
+double ImageLabel::_scale() const {
+    auto const fitted = std::min(contentsRect().width() / static_cast<double>(EzGraver::ImageWidth),
+                                 contentsRect().height() / static_cast<double>(EzGraver::ImageHeight));
+    return fitted * _zoom;
+}
+
+QRectF ImageLabel::_canvasTarget() const {
+    auto const scale = _scale();
+    auto const topLeft = QRectF{contentsRect()}.center() - _center * scale;
+    return QRectF{topLeft, QSizeF{EzGraver::ImageWidth * scale, EzGraver::ImageHeight * scale}};
+}
+
+void ImageLabel::_setView(double zoom, QPointF const& center) {
+    _zoom = qBound(1.0, zoom, MaximumZoom);
+    _center = QPointF{qBound(0.0, center.x(), static_cast<double>(EzGraver::ImageWidth)),
+                      qBound(0.0, center.y(), static_cast<double>(EzGraver::ImageHeight))};
+    update();
+}
+
+void ImageLabel::paintEvent(QPaintEvent* event) {
+    if(_rasterPyramid.isNull()) {
+        ClickLabel::paintEvent(event);
+        return;
+    }
+    if(_showSource && _sourcePyramid.isNull() && _decodeImage()) {
+        _sourcePyramid.setImage(_image);
+    }
+
+    QPainter painter{this};
+    drawFrame(&painter);
+    auto const exposed = event->rect() & contentsRect();
+    painter.setClipRect(exposed);
+
+    auto const canvas = _canvasTarget();
+    auto const scale = _scale();
+    if(_showSource && !_sourcePyramid.isNull()) {
+        // Areas not covered by the source are white on the canvas as well.
+        painter.fillRect(canvas, Qt::white);
+        auto const area = _sourceArea();
+        QRectF target{canvas.left() + area.left() * scale, canvas.top() + area.top() * scale,
+                      area.width() * scale, area.height() * scale};
+        _sourcePyramid.draw(painter, target, exposed);
+    } else {
+        _rasterPyramid.draw(painter, canvas, exposed);
+    }
+
+    // Burned pixels are drawn for the visible part of the canvas only.
+    QRectF visible{(exposed.left() - canvas.left()) / scale, (exposed.top() - canvas.top()) / scale,
+                   exposed.width() / scale, exposed.height() / scale};
+    auto const burned = visible.toAlignedRect() & _layerBurn.rect();
+    if(!burned.isEmpty()) {
+        QRectF target{canvas.left() + burned.left() * scale, canvas.top() + burned.top() * scale,
+                      burned.width() * scale, burned.height() * scale};
+        painter.drawImage(target, _layerBurn, burned);
+    }
+}
+
+void ImageLabel::wheelEvent(QWheelEvent* event) {
+    if(_rasterPyramid.isNull()) {
+        ClickLabel::wheelEvent(event);
+        return;
+    }
+
+    auto const zoom = qBound(1.0, _zoom * std::pow(ZoomStep, event->angleDelta().y() / 120.0), MaximumZoom);
+    auto const scale = _scale() / _zoom * zoom;
+    QPointF const position{event->pos()};
+    auto const point = (position - _canvasTarget().topLeft()) / _scale();
+    _setView(zoom, point - (position - QRectF{contentsRect()}.center()) / scale);
+    event->accept();
+}
+
+void ImageLabel::mousePressEvent(QMouseEvent* event) {
+    _pressPosition = event->pos();
+    _pressCenter = _center;
+    _dragging = false;
+    ClickLabel::mousePressEvent(event);
+}
+
+void ImageLabel::mouseMoveEvent(QMouseEvent* event) {
+    // Only zoomed images can be panned, short movements still count as clicks.
+    auto const delta = event->pos() - _pressPosition;
+    if((event->buttons() & Qt::LeftButton) && _zoom > 1.0
+            && (_dragging || delta.manhattanLength() >= QApplication::startDragDistance())) {
+        _dragging = true;
+        setCursor(Qt::ClosedHandCursor);
+        _setView(_zoom, _pressCenter - QPointF{delta} / _scale());
+    }
+    ClickLabel::mouseMoveEvent(event);
+}
+
+void ImageLabel::mouseReleaseEvent(QMouseEvent* event) {
+    if(_dragging) {
+        _dragging = false;
+        unsetCursor();
+        return;
+    }
+    if(event->button() == Qt::MiddleButton) {
+        resetZoom();
+        return;
+    }
+    ClickLabel::mouseReleaseEvent(event);
+}
@@ -1,16 +1,32 @@
 #ifndef IMAGELABEL_H
 #define IMAGELABEL_H
 
+#include <QTimer>
+#include <QFuture>
+
 #include "clicklabel.h"
+#include "tone.h"
+#include "binarizer.h"
+#include "bitmapcache.h"
+#include "budget.h"
+#include "filterpipeline.h"
+#include "burnsimulator.h"
+#include "imagepyramid.h"
 
 class ImageLabel : public ClickLabel {
     Q_OBJECT
     Q_PROPERTY(QImage image READ image WRITE setImage NOTIFY imageChanged)
     Q_PROPERTY(Qt::ImageConversionFlags conversionFlags READ conversionFlags WRITE setConversionFlags NOTIFY conversionFlagsChanged)
+    Q_PROPERTY(BinarizerSettings::Mode conversionMode READ conversionMode WRITE setConversionMode NOTIFY conversionModeChanged)
+    Q_PROPERTY(EdgeSettings edgeSettings READ edgeSettings WRITE setEdgeSettings NOTIFY edgeSettingsChanged)
+    Q_PROPERTY(ThresholdSettings thresholdSettings READ thresholdSettings WRITE setThresholdSettings NOTIFY thresholdSettingsChanged)
     Q_PROPERTY(bool grayscale READ grayscale WRITE setGrayscale NOTIFY grayscaleChanged)
     Q_PROPERTY(int layer READ layer WRITE setLayer NOTIFY layerChanged)
     Q_PROPERTY(int layerCount READ layerCount WRITE setLayerCount NOTIFY layerCountChanged)
     Q_PROPERTY(bool keepAspectRatio READ keepAspectRatio WRITE setKeepAspectRatio NOTIFY keepAspectRatioChanged)
+    Q_PROPERTY(ToneSettings tone READ tone WRITE setTone NOTIFY toneChanged)
+    Q_PROPERTY(bool showSource READ showSource WRITE setShowSource NOTIFY showSourceChanged)
+    Q_PROPERTY(BudgetSettings budget READ budget WRITE setBudget NOTIFY budgetChanged)
     Q_PROPERTY(bool imageLoaded READ imageLoaded NOTIFY imageLoadedChanged)
     Q_PROPERTY(int picX READ picX)
     Q_PROPERTY(int picY READ picY)
@@ -32,12 +48,30 @@ public:
 
     /*!
      * Gets the currently loaded image without the application of
-     * any conversion.
+     * any conversion. Images loaded from a file are decoded on demand.
      *
      * \return The currently loaded image.
      */
     QImage image() const;
 
+    /*!
+     * Displays an already converted raster, such as nested designs. The conversion
+     * settings do not apply to it, the raster is uploaded as it is.
+     *
+     * \param raster The image in the format \c QImage::Format_Mono with black pixels to be burned.
+     */
+    void setRaster(QImage const& raster);
+
+    /*!
+     * Loads the given image file and applies the selected conversion method. The
+     * processed bitmaps are cached on disk by the content of the file and the
+     * conversion settings; the image is only decoded if the cache misses.
+     *
+     * \param fileName The file to load.
+     * \return \c true if the image could be loaded.
+     */
+    bool loadImage(QString const& fileName);
+
     /*!
      * Changes the currently displayed image to the given image
      * and applies the selected conversion method.
@@ -61,6 +95,51 @@ public:
      */
     void setConversionFlags(Qt::ImageConversionFlags const& flags);
 
+    /*!
+     * Gets the currently selected conversion mode.
+     *
+     * \return The currently selected conversion mode.
+     */
+    BinarizerSettings::Mode conversionMode() const;
+
+    /*!
+     * Changes the conversion mode to the given one and updates the currently
+     * displayed image. The mode is ignored for grayscale images.
+     *
+     * \param mode The conversion mode to use.
+     */
+    void setConversionMode(BinarizerSettings::Mode const& mode);
+
+    /*!
+     * Gets the settings of the edge detection.
+     *
+     * \return The edge settings.
+     */
+    EdgeSettings edgeSettings() const;
+
+    /*!
+     * Changes the settings of the edge detection and updates the currently
+     * displayed image.
+     *
+     * \param edgeSettings The edge settings to use.
+     */
+    void setEdgeSettings(EdgeSettings const& edgeSettings);
+
+    /*!
+     * Gets the settings of the adaptive thresholding.
+     *
+     * \return The threshold settings.
+     */
+    ThresholdSettings thresholdSettings() const;
+
+    /*!
+     * Changes the settings of the adaptive thresholding and updates the currently
+     * displayed image.
+     *
+     * \param thresholdSettings The threshold settings to use.
+     */
+    void setThresholdSettings(ThresholdSettings const& thresholdSettings);
+
     /*!
      * Gets if grayscale is enabled.
      *
@@ -117,6 +196,81 @@ public:
      */
     void setKeepAspectRatio(bool const& keepAspectRatio);
 
+    /*!
+     * Gets the tone adjustment applied before the image is binarized.
+     *
+     * \return The tone settings.
+     */
+    ToneSettings tone() const;
+
+    /*!
+     * Changes the tone adjustment applied before the image is binarized and
+     * updates the currently displayed image.
+     *
+     * \param tone The tone settings to use.
+     */
+    void setTone(ToneSettings const& tone);
+
+    /*!
+     * Gets the budget the conversion is fitted into.
+     *
+     * \return The budget settings.
+     */
+    BudgetSettings budget() const;
+
+    /*!
+     * Changes the budget the conversion is fitted into and updates the currently
+     * displayed image. The budget is ignored for grayscale images.
+     *
+     * \param budget The budget settings to use.
+     */
+    void setBudget(BudgetSettings const& budget);
+
+    /*!
+     * Gets the offset applied to fit the conversion into the budget.
+     *
+     * \return The brightness or threshold offset, \c 0 if no budget is set.
+     */
+    int budgetOffset() const;
+
+    /*!
+     * Gets if the displayed image meets the budget.
+     *
+     * \return \c true if the budget is met or none is set.
+     */
+    bool budgetMet() const;
+
+    /*!
+     * Gets the estimator used for duration budgets, shared with the owner of the label
+     * so it can be calibrated with completed jobs.
+     *
+     * \return The duration estimator.
+     */
+    DurationEstimator& estimator();
+
+    /*!
+     * Gets the preprocessing stages loaded from plugins, shared with the owner of the label
+     * so it can load them.
+     *
+     * \return The filter pipeline.
+     */
+    FilterPipeline& filters();
+
+    /*!
+     * Gets if the preprocessing stages are applied.
+     *
+     * \return \c true if the filters are applied.
+     */
+    bool filtersEnabled() const;
+
+    /*!
+     * Enables/disables the preprocessing stages applied after the tone adjustment and
+     * before the binarization, and updates the currently displayed image.
+     *
+     * \param enabled \c true if the filters should be applied.
+     */
+    void setFiltersEnabled(bool enabled);
+
     /*!
      * Gets if an image has been loaded.
      *
@@ -160,6 +314,29 @@ public:
      */
     int picH() const;
 
+    /*!
+     * Gets the image as it is passed to the binarization, i.e. placed onto the
+     * canvas of the engraver, tone adjusted and filtered.
+     *
+     * \return The adjusted image or a null image if none is loaded.
+     */
+    QImage adjustedImage();
+
+    /*!
+     * Gets the device ready bitmap of the currently displayed image. This is exactly
+     * the previewed raster without any burn status and can be uploaded as is.
+     *
+     * \return The bitmap or a null image if the current settings do not result in a single layer.
+     */
+    QImage bitmap() const;
+
+    /*!
+     * Gets the statistics of the device ready bitmap of the currently displayed image.
+     *
+     * \return The statistics of the bitmap.
+     */
+    BitmapStats stats() const;
+
     /*!
      * Gets number of pixels to be burned.
      *
@@ -169,7 +346,8 @@ public:
     {   return _burnCount;  }
 
     /*!
-     * Marks a pixel as burned.
+     * Marks a pixel as burned. The displayed image is only updated by \a updateInfoLayers,
+     * which allows marking a whole batch of pixels at once.
      *
      * \return The number of already burned pixels.
      */
@@ -181,7 +359,50 @@ public:
     void resetBurnStatus();
 
     /*!
-     * Redraws image with upper layers.
+     * Gets if the source image is shown instead of the converted raster.
+     *
+     * \return \c true if the source image is shown.
+     */
+    bool showSource() const;
+
+    /*!
+     * Switches between showing the source image and the converted raster.
+     *
+     * \param showSource \c true to show the source image.
+     */
+    void setShowSource(bool showSource);
+
+    /*!
+     * Gets if the simulated burn result is shown instead of the converted raster.
+     *
+     * \return \c true if the simulation is shown.
+     */
+    bool simulated() const;
+
+    /*!
+     * Shows the expected burn result of the converted raster on the given material
+     * instead of the raster itself. Grayscale layers are always shown unsimulated.
+     *
+     * \param enabled \c true to show the simulation.
+     * \param material The material engraved.
+     * \param burnTime The burn time per pixel.
+     */
+    void setSimulation(bool enabled, MaterialProfile const& material, int burnTime);
+
+    /*!
+     * Gets the current zoom factor relative to the image fitted into the label.
+     *
+     * \return The zoom factor, 1 if the image is fitted.
+     */
+    double zoom() const;
+
+    /*!
+     * Fits the whole image into the label again.
+     */
+    void resetZoom();
+
+    /*!
+     * Redraws the area of the pixels marked as burned since the last call.
      */
     void updateInfoLayers();
 
@@ -189,7 +410,8 @@ signals:
     /*!
      * Fired as soon as the image has been changed.
      *
-     * \param image The new image in its original state (unconverted).
+     * \param image The new image in its original state (unconverted), null if it
+     *        has not been decoded because its bitmap was cached.
      */
     void imageChanged(QImage const& image);
 
@@ -200,6 +422,27 @@ signals:
      */
     void conversionFlagsChanged(Qt::ImageConversionFlags const& flags);
 
+    /*!
+     * Fired as soon as the conversion mode has been changed.
+     *
+     * \param mode The newly applied conversion mode.
+     */
+    void conversionModeChanged(BinarizerSettings::Mode const& mode);
+
+    /*!
+     * Fired as soon as the edge settings changed.
+     *
+     * \param edgeSettings The currently active edge settings.
+     */
+    void edgeSettingsChanged(EdgeSettings const& edgeSettings);
+
+    /*!
+     * Fired as soon as the threshold settings changed.
+     *
+     * \param thresholdSettings The currently active threshold settings.
+     */
+    void thresholdSettingsChanged(ThresholdSettings const& thresholdSettings);
+
     /*!
      * Fired as soon as grayscale has been enabled or disabled.
      *
@@ -228,6 +471,25 @@ signals:
      */
     void keepAspectRatioChanged(bool const& keepAspectRatio);
 
+    /*!
+     * Fired as soon as the tone settings changed.
+     *
+     * \param tone The currently active tone settings.
+     */
+    void toneChanged(ToneSettings const& tone);
+
+    /*!
+     * Fired as soon as the displayed image and its bitmap have been updated.
+     */
+    void bitmapChanged();
+
+    /*!
+     * Fired as soon as the budget changed.
+     *
+     * \param budget The currently active budget.
+     */
+    void budgetChanged(BudgetSettings const& budget);
+
     /*!
      * Fired as soon as an image has been loaded.
      *
@@ -235,27 +497,102 @@ signals:
      */
     void imageLoadedChanged(bool imageLoaded);
 
+    /*!
+     * Fired as soon as the shown image was switched.
+     *
+     * \param showSource \c true if the source image is shown.
+     */
+    void showSourceChanged(bool showSource);
+
+protected:
+    /*!
+     * Draws only the tiles of the shown image and the burned pixels which are visible.
+     *
+     * \param event The paint event.
+     */
+    void paintEvent(QPaintEvent* event);
+
+    /*!
+     * Zooms in or out, keeping the point below the cursor in place.
+     *
+     * \param event The wheel event.
+     */
+    void wheelEvent(QWheelEvent* event);
+
+    void mousePressEvent(QMouseEvent* event);
+    void mouseMoveEvent(QMouseEvent* event);
+
+    /*!
+     * Registers a click unless the image has been dragged. A click with the middle
+     * button fits the image into the label again.
+     *
+     * \param event The mouse event.
+     */
+    void mouseReleaseEvent(QMouseEvent* event);
+
 private:
-    QImage _image;
+    mutable QImage _image;
+    QString _fileName;
+    QByteArray _sourceHash;
+    BitmapCache _cache;
+    QTimer _cacheTimer;
+    QFuture<void> _cacheStore;
+    QByteArray _cacheKeyPending;
+    QImage _cacheBitmap;
+    BitmapStats _cacheStats;
+    bool _converted;
+    QImage _composed;
     QImage _displayImg;
+    QImage _bitmap;
     QImage _layerBurn;
 
-    Qt::ImageConversionFlags _flags;
+    BinarizerSettings _binarizer;
     bool _grayscale;
     int _layer;
     int _layerCount;
     bool _keepAspectRatio;
+    ToneSettings _tone;
+    BudgetSettings _budget;
+    DurationEstimator _estimator;
+    FilterPipeline _filters;
+    bool _filtersEnabled = false;
+    int _budgetOffset = 0;
+    bool _budgetMet = true;
     int _picX0 = 0;
     int _picY0 = 0;
     int _picX1 = 0;
     int _picY1 = 0;
+    BitmapStats _stats;
     int _burnCount = 0;
     int _burnedCount = 0;
+    QRect _burnDirty;
+    ImagePyramid _rasterPyramid;
+    ImagePyramid _sourcePyramid;
+    bool _showSource = false;
+    bool _simulated = false;
+    MaterialProfile _material;
+    int _simulatedBurnTime = 0;
+    double _zoom = 1.0;
+    QPointF _center;
+    QPoint _pressPosition;
+    QPointF _pressCenter;
+    bool _dragging = false;
 
     void updateDisplayedImage();
-    void updateDimensions(QImage const & image);
+    void _assignImage(QImage const& image);
+    bool _decodeImage() const;
+    QByteArray _cacheKey(QByteArray const& sourceHash) const;
+    void _composeImage();
+    void _storeCached();
+    QImage _preprocessImage() const;
+    void _updateRaster();
+    void updateDimensions(BitmapStats const& stats);
     QImage _createGrayscaleImage(QImage const& original) const;
     QVector<QRgb> _createColorTable() const;
+    QRectF _sourceArea() const;
+    double _scale() const;
+    QRectF _canvasTarget() const;
+    void _setView(double zoom, QPointF const& center);
 };
 
 #endif // IMAGELABEL_H
@@ -0,0 +1,93 @@
+#include "imagepyramid.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+ImagePyramid::ImagePyramid() : _levels{}, _tiles{} {}
+
+void ImagePyramid::setImage(QImage const& image) {
+    _levels.clear();
+    _tiles.clear();
+    if(!image.isNull()) {
+        _levels.append(image.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    }
+}
+
+bool ImagePyramid::isNull() const {
+    return _levels.isEmpty();
+}
+
+QSize ImagePyramid::size() const {
+    return isNull() ? QSize{} : _levels.first().size();
+}
+
+int ImagePyramid::levelFor(double scale) const {
+    if(isNull() || scale >= 1.0) {
+        return 0;
+    }
+
+    // Levels are halved until a single pixel remains.
+    auto const largest = std::max(size().width(), size().height());
+    auto const maximum = static_cast<int>(std::log2(largest));
+    return std::min(maximum, static_cast<int>(std::floor(std::log2(1.0 / scale))));
+}
+
+void ImagePyramid::draw(QPainter& painter, QRectF const& target, QRect const& exposed) {
+    if(isNull() || target.isEmpty()) {
+        return;
+    }
+
+    auto const scale = std::min(target.width() / size().width(), target.height() / size().height());
+    auto const level = levelFor(scale);
+    auto const& image = _level(level);
+    auto const scaleX = target.width() / image.width();
+    auto const scaleY = target.height() / image.height();
+
+    // Single pixels are supposed to stay visible when zooming in.
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, scaleX < 1.0 || scaleY < 1.0);
+
+    QRectF visible{(exposed.left() - target.left()) / scaleX, (exposed.top() - target.top()) / scaleY,
+                   exposed.width() / scaleX, exposed.height() / scaleY};
+    visible &= QRectF{QPointF{0, 0}, image.size()};
+    if(!visible.isEmpty()) {
+        auto const firstColumn = static_cast<int>(visible.left()) / TileSize;
+        auto const lastColumn = static_cast<int>(std::ceil(visible.right())) / TileSize;
+        auto const firstRow = static_cast<int>(visible.top()) / TileSize;
+        auto const lastRow = static_cast<int>(std::ceil(visible.bottom())) / TileSize;
+        for(int row{firstRow}; row <= lastRow; ++row) {
+            for(int column{firstColumn}; column <= lastColumn; ++column) {
+                auto const& tile = _tile(level, column, row);
+                if(tile.isNull()) {
+                    continue;
+                }
+                QRectF destination{target.left() + column * TileSize * scaleX, target.top() + row * TileSize * scaleY,
+                                   tile.width() * scaleX, tile.height() * scaleY};
+                painter.drawPixmap(destination, tile, QRectF{tile.rect()});
+            }
+        }
+    }
+    painter.restore();
+}
+
+QImage const& ImagePyramid::_level(int level) {
+    while(_levels.size() <= level) {
+        auto const& previous = _levels.last();
+        auto const width = std::max(1, previous.width() / 2);
+        auto const height = std::max(1, previous.height() / 2);
+        _levels.append(previous.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    }
+    return _levels[level];
+}
+
+QPixmap const& ImagePyramid::_tile(int level, int column, int row) {
+    auto const key = (static_cast<quint64>(level) << 48) | (static_cast<quint64>(row) << 24) | static_cast<quint64>(column);
+    auto tile = _tiles.find(key);
+    if(tile == _tiles.end()) {
+        auto const area = QRect{column * TileSize, row * TileSize, TileSize, TileSize} & _levels[level].rect();
+        tile = _tiles.insert(key, area.isEmpty() ? QPixmap{} : QPixmap::fromImage(_levels[level].copy(area)));
+    }
+    return *tile;
+}
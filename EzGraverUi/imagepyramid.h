@@ -0,0 +1,74 @@
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QHash>
+#include <QVector>
+
+class QPainter;
+
+/*!
+ * A mipmap pyramid of an image, split into tiles which are turned into pixmaps
+ * on first use. Drawing picks the level matching the scale and only touches the
+ * tiles intersecting the exposed area, so the costs per paint do not depend on
+ * the size of the image.
+ */
+class ImagePyramid {
+public:
+    /*! The edge length of the tiles in pixels. */
+    static int const TileSize{128};
+
+    /*!
+     * Creates an empty pyramid.
+     */
+    ImagePyramid();
+
+    /*!
+     * Replaces the image of the pyramid, dropping all cached levels and tiles.
+     *
+     * \param image The image to display.
+     */
+    void setImage(QImage const& image);
+
+    /*!
+     * Checks if the pyramid holds an image.
+     *
+     * \return \c true if no image is set.
+     */
+    bool isNull() const;
+
+    /*!
+     * Gets the size of the full resolution image.
+     *
+     * \return The size of the image.
+     */
+    QSize size() const;
+
+    /*!
+     * Gets the level to draw at the given scale, i.e. the coarsest level which is
+     * not scaled up.
+     *
+     * \param scale The scale of the full resolution image.
+     * \return The index of the level, 0 being the full resolution.
+     */
+    int levelFor(double scale) const;
+
+    /*!
+     * Draws the image.
+     *
+     * \param painter The painter to draw with.
+     * \param target The area the whole image is mapped to.
+     * \param exposed The area which actually has to be painted.
+     */
+    void draw(QPainter& painter, QRectF const& target, QRect const& exposed);
+
+private:
+    QVector<QImage> _levels;
+    QHash<quint64, QPixmap> _tiles;
+
+    QImage const& _level(int level);
+    QPixmap const& _tile(int level, int column, int row);
+};
+
+#endif // IMAGEPYRAMID_H
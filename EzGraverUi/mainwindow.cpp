@@ -7,20 +7,38 @@
 #include <QBitmap>
 #include <QIcon>
 #include <QThreadPool>
+#include <QShortcut>
+#include <QMessageBox>
 #include <QDebug>
 
 #include <stdexcept>
 
+#include "imageloader.h"
+#include "comparedialog.h"
+#include "telemetrydialog.h"
+#include "nestdialog.h"
+#include "layoutoptimizer.h"
+
 MainWindow::MainWindow(QWidget* parent)
         :  QMainWindow{parent}, _ui{new Ui::MainWindow},
-          _portTimer{}, _ezGraver{}, _bytesWrittenProcessor{[](qint64){}}, _connected{false} {
+          _portWatcher{}, _reportTimer{}, _jogTimer{}, _ezGraver{}, _bytesWrittenProcessor{[](qint64){}}, _connected{false},
+          _uploaded{false}, _jobStarted{false}, _jobPaused{false}, _telemetry{}, _telemetryDialog{NULL},
+          _uploadedStats{0, QRect{}, 0, 0}, _uploadedBitmap{}, _burnProgress{}, _jogX{0}, _jogY{0} {
     _ui->setupUi(this);
     setAcceptDrops(true);
 
-    connect(&_portTimer, &QTimer::timeout, this, &MainWindow::updatePorts);
-    _portTimer.start(PortUpdateDelay);
+    connect(&_portWatcher, &PortWatcher::portsChanged, this, &MainWindow::updatePorts);
+    connect(&_portWatcher, &PortWatcher::portAdded, [this](QString const& port) { _printVerbose(QString{"port added: %1"}.arg(port)); });
+    connect(&_portWatcher, &PortWatcher::portRemoved, [this](QString const& port) { _printVerbose(QString{"port removed: %1"}.arg(port)); });
+    updatePorts(_portWatcher.ports());
+
+    connect(&_reportTimer, &QTimer::timeout, this, &MainWindow::drainReports);
 
     _initBindings();
+    _initToneBindings();
+    _initBudgetBindings();
+    _initJogBindings();
+    _initFilters();
     _initConversionFlags();
     _setConnected(false);
     _setUploaded(false);
@@ -34,12 +52,22 @@ MainWindow::~MainWindow() {
 
 void MainWindow::_initBindings() {
     connect(_ui->burnTime, &QSlider::valueChanged, [this](int const& v) { _ui->burnTimeLabel->setText(QString::number(v)); });
+    connect(_ui->burnTime, &QSlider::valueChanged, this, &MainWindow::_updateEstimate);
+    connect(_ui->image, &ImageLabel::bitmapChanged, this, &MainWindow::_updateEstimate);
 
     connect(this, &MainWindow::connectedChanged, this, &MainWindow::enableControls);
     connect(this, &MainWindow::uploadedChanged,  this, &MainWindow::enableControls);
 
     connect(_ui->conversionFlags, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this](int index) {
+        auto mode = static_cast<BinarizerSettings::Mode>(_ui->conversionFlags->itemData(index, ConversionModeRole).toInt());
+        for(auto slider : {_ui->edgeLow, _ui->edgeHigh, _ui->edgeSigma}) {
+            slider->setEnabled(mode == BinarizerSettings::Edges);
+        }
+        for(auto slider : {_ui->thresholdWindow, _ui->thresholdK}) {
+            slider->setEnabled(mode == BinarizerSettings::Adaptive);
+        }
         _ui->image->setConversionFlags(static_cast<Qt::ImageConversionFlags>(_ui->conversionFlags->itemData(index).toInt()));
+        _ui->image->setConversionMode(mode);
     });
 
     connect(_ui->layered, &QCheckBox::toggled, _ui->selectedLayer, &QSpinBox::setEnabled);
@@ -59,6 +87,126 @@ void MainWindow::_initBindings() {
     connect(_ui->selectedLayer, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), uploadEnabled);
     connect(_ui->layered, &QCheckBox::toggled, uploadEnabled);
     connect(_ui->keepAspectRatio, &QCheckBox::toggled, _ui->image, &ImageLabel::setKeepAspectRatio);
+    connect(_ui->showSource, &QCheckBox::toggled, _ui->image, &ImageLabel::setShowSource);
+
+    auto compareEnabled = [this] {
+        _ui->compare->setEnabled(_ui->image->imageLoaded() && !_ui->layered->isChecked());
+        _ui->optimizeLayout->setEnabled(_ui->image->imageLoaded() && !_ui->layered->isChecked());
+    };
+    connect(_ui->image, &ImageLabel::imageLoadedChanged, compareEnabled);
+    connect(_ui->layered, &QCheckBox::toggled, compareEnabled);
+
+    auto const materials = MaterialProfile::defaults();
+    for(auto const& material : materials) {
+        _ui->material->addItem(material.name);
+    }
+    auto updateSimulation = [this, materials] {
+        auto const enabled = _ui->simulate->isChecked();
+        _ui->material->setEnabled(enabled);
+        _ui->image->setSimulation(enabled, materials.value(_ui->material->currentIndex()), _ui->burnTime->value());
+    };
+    connect(_ui->simulate, &QCheckBox::toggled, updateSimulation);
+    connect(_ui->material, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), updateSimulation);
+    connect(_ui->burnTime, &QSlider::valueChanged, updateSimulation);
+}
+
+void MainWindow::_initToneBindings() {
+    auto updateTone = [this] {
+        ToneSettings tone{};
+        tone.brightness = _ui->brightness->value();
+        tone.contrast = _ui->contrast->value();
+        tone.gamma = _ui->gamma->value() / 100.0;
+        tone.sharpenAmount = _ui->sharpen->value() / 100.0;
+        tone.autoLevels = _ui->autoLevels->isChecked();
+        tone.redWeight = _ui->redWeight->value();
+        tone.greenWeight = _ui->greenWeight->value();
+        tone.blueWeight = _ui->blueWeight->value();
+        _ui->image->setTone(tone);
+    };
+
+    for(auto slider : {_ui->brightness, _ui->contrast, _ui->gamma, _ui->sharpen}) {
+        connect(slider, &QSlider::valueChanged, updateTone);
+    }
+    for(auto spinBox : {_ui->redWeight, _ui->greenWeight, _ui->blueWeight}) {
+        connect(spinBox, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), updateTone);
+    }
+    connect(_ui->autoLevels, &QCheckBox::toggled, updateTone);
+
+    auto updateEdges = [this] {
+        EdgeSettings edges{};
+        edges.lowThreshold = _ui->edgeLow->value();
+        edges.highThreshold = _ui->edgeHigh->value();
+        edges.sigma = _ui->edgeSigma->value() / 10.0;
+        _ui->image->setEdgeSettings(edges);
+    };
+    for(auto slider : {_ui->edgeLow, _ui->edgeHigh, _ui->edgeSigma}) {
+        connect(slider, &QSlider::valueChanged, updateEdges);
+    }
+
+    auto updateThreshold = [this] {
+        ThresholdSettings threshold{};
+        threshold.window = _ui->thresholdWindow->value();
+        threshold.k = _ui->thresholdK->value() / 100.0;
+        _ui->image->setThresholdSettings(threshold);
+    };
+    for(auto slider : {_ui->thresholdWindow, _ui->thresholdK}) {
+        connect(slider, &QSlider::valueChanged, updateThreshold);
+    }
+}
+
+void MainWindow::_initBudgetBindings() {
+    _ui->budgetKind->addItem("None");
+    _ui->budgetKind->addItem("Seconds");
+    _ui->budgetKind->addItem("Pixels");
+
+    auto updateBudget = [this] {
+        // The burn time only matters to duration budgets, other budgets are not refitted when it changes.
+        BudgetSettings budget{};
+        if(_ui->budgetKind->currentIndex() == 1) {
+            budget.maxSeconds = _ui->budgetLimit->value();
+            budget.burnTime = _ui->burnTime->value();
+        } else if(_ui->budgetKind->currentIndex() == 2) {
+            budget.maxPixels = _ui->budgetLimit->value();
+        }
+        _ui->budgetLimit->setEnabled(budget.isActive());
+
+        if(budget != _ui->image->budget()) {
+            _ui->image->setBudget(budget);
+        }
+    };
+    connect(_ui->budgetKind, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), updateBudget);
+    connect(_ui->budgetLimit, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), updateBudget);
+    connect(_ui->burnTime, &QSlider::valueChanged, updateBudget);
+}
+
+void MainWindow::_initJogBindings() {
+    _jogTimer.setInterval(JogDelay);
+    connect(&_jogTimer, &QTimer::timeout, this, &MainWindow::_sendJog);
+
+    struct Binding { int key; int dx; int dy; };
+    for(auto const& binding : {Binding{Qt::Key_Up, 0, -1}, Binding{Qt::Key_Down, 0, 1},
+                               Binding{Qt::Key_Left, -1, 0}, Binding{Qt::Key_Right, 1, 0}}) {
+        auto shortcut = new QShortcut{QKeySequence{Qt::CTRL + binding.key}, this};
+        connect(shortcut, &QShortcut::activated, [this, binding] {
+            if(_connected) {
+                _jog(binding.dx, binding.dy);
+            }
+        });
+    }
+}
+
+void MainWindow::_initFilters() {
+    auto const directory = FilterPipeline::defaultDirectory();
+    if(_ui->image->filters().load(directory) == 0) {
+        _ui->filters->setToolTip(QString{"Place filter plugins into %1 to enable them"}.arg(directory));
+        return;
+    }
+
+    auto const names = _ui->image->filters().names();
+    _printVerbose(QString{"loaded filter plugins: %1"}.arg(names.join(", ")));
+    _ui->filters->setToolTip(QString{"Applies %1 after the tone adjustment"}.arg(names.join(", ")));
+    _ui->filters->setEnabled(true);
+    connect(_ui->filters, &QCheckBox::toggled, _ui->image, &ImageLabel::setFiltersEnabled);
 }
 
 void MainWindow::enableControls()
@@ -77,21 +225,49 @@ void MainWindow::enableControls()
     _ui->start->setEnabled(_connected && _uploaded);
     _ui->pause->setEnabled(_connected);
     _ui->reset->setEnabled(_connected);
+    _ui->resume->setEnabled(_connected && _burnProgress.count() > 0 && !_uploadedBitmap.isNull());
 }
 
 void MainWindow::_initConversionFlags() {
-    _ui->conversionFlags->addItem("DiffuseDither", Qt::DiffuseDither);
-    _ui->conversionFlags->addItem("OrderedDither", Qt::OrderedDither);
-    _ui->conversionFlags->addItem("ThresholdDither", Qt::ThresholdDither);
+    _addConversionMode("DiffuseDither", BinarizerSettings::Dither, Qt::DiffuseDither);
+    _addConversionMode("OrderedDither", BinarizerSettings::Dither, Qt::OrderedDither);
+    _addConversionMode("ThresholdDither", BinarizerSettings::Dither, Qt::ThresholdDither);
+    _addConversionMode("Edges", BinarizerSettings::Edges, Qt::ThresholdDither);
+    _addConversionMode("Adaptive", BinarizerSettings::Adaptive, Qt::ThresholdDither);
     _ui->conversionFlags->setCurrentIndex(0);
 }
 
+void MainWindow::_addConversionMode(QString const& name, BinarizerSettings::Mode mode, Qt::ImageConversionFlags flags) {
+    _ui->conversionFlags->addItem(name, static_cast<int>(flags));
+    _ui->conversionFlags->setItemData(_ui->conversionFlags->count() - 1, mode, ConversionModeRole);
+}
+
+void MainWindow::_updateEstimate() {
+    if(!_ui->image->imageLoaded() || _ui->image->bitmap().isNull()) {
+        _ui->estimate->setText("Estimated duration: -");
+        return;
+    }
+
+    if(_ui->image->budget().isActive() && !_ui->layered->isChecked()) {
+        _ui->budgetResult->setText(QString{"%1 with offset %2, burning %3 pixels"}
+                .arg(_ui->image->budgetMet() ? "Budget met" : "Budget exceeded")
+                .arg(_ui->image->budgetOffset())
+                .arg(_ui->image->burnCount()));
+    } else {
+        _ui->budgetResult->clear();
+    }
+
+    auto const seconds = qRound(_ui->image->estimator().estimate(_ui->image->stats(), _ui->burnTime->value()));
+    _ui->estimate->setText(QString{"Estimated duration: %1:%2 (calibrated by %3 jobs)"}
+            .arg(seconds / 60).arg(seconds % 60, 2, 10, QChar{'0'}).arg(_ui->image->estimator().jobCount()));
+}
+
 void MainWindow::_printVerbose(QString const& verbose) {
     _ui->verbose->appendPlainText(verbose);
 }
 
-void MainWindow::updatePorts() {
-    QStringList ports{EzGraver::availablePorts()};
+void MainWindow::updatePorts(QStringList const& availablePorts) {
+    QStringList ports{availablePorts};
     ports.insert(0, "");
 
     QString original{_ui->ports->currentText()};
@@ -106,13 +282,9 @@ void MainWindow::updatePorts() {
 void MainWindow::_loadImage(QString const& fileName) {
     _printVerbose(QString{"loading image: %1"}.arg(fileName));
 
-    QImage image{};
-    if(!image.load(fileName)) {
+    if(!_ui->image->loadImage(fileName)) {
         _printVerbose("failed to load image");
-        return;
     }
-
-    _ui->image->setImage(image);
 }
 
 bool MainWindow::connected() const {
@@ -150,13 +322,12 @@ void MainWindow::updateProgress(qint64 bytes) {
 void MainWindow::on_connect_clicked() {
     try {
         _printVerbose(QString{"connecting to port %1"}.arg(_ui->ports->currentText()));
-        _ezGraver = EzGraver::create(_ui->ports->currentText());
+        _ezGraver = EzGraver::create(_ui->ports->currentText(), true);
         _printVerbose("connection established successfully");
         _setConnected(true);
-        _inData.clear();
 
         connect(_ezGraver->serialPort().get(), &QSerialPort::bytesWritten, this, &MainWindow::bytesWritten);
-        connect(_ezGraver->serialPort().get(), &QSerialPort::readyRead, this, &MainWindow::readyRead);
+        _reportTimer.start(ReportDrainDelay);
     } catch(std::runtime_error const& e) {
         _printVerbose(QString{"Error: %1"}.arg(e.what()));
     }
@@ -164,46 +335,119 @@ void MainWindow::on_connect_clicked() {
 
 void MainWindow::on_home_clicked() {
     _printVerbose("moving to home");
+    _cancelJog();
     _ezGraver->home();
 }
 
 void MainWindow::on_up_clicked() {
-    _ezGraver->up();
+    _jog(0, -1);
 }
 
 void MainWindow::on_left_clicked() {
-    _ezGraver->left();
+    _jog(-1, 0);
 }
 
 void MainWindow::on_center_clicked() {
     _printVerbose("moving to center");
+    _cancelJog();
     _ezGraver->center();
 }
 
 void MainWindow::on_right_clicked() {
-    _ezGraver->right();
+    _jog(1, 0);
 }
 
 void MainWindow::on_down_clicked() {
-    _ezGraver->down();
+    _jog(0, 1);
+}
+
+void MainWindow::_jog(int dx, int dy) {
+    // Auto-repeated keys and buttons are accumulated while a move is in flight and sent as a single batch.
+    auto const limit = static_cast<int>(EzGraver::MaxMoveSteps);
+    _jogX = qBound(-limit, _jogX + dx, limit);
+    _jogY = qBound(-limit, _jogY + dy, limit);
+    if(!_jogTimer.isActive()) {
+        _sendJog();
+        _jogTimer.start();
+    }
+}
+
+void MainWindow::_sendJog() {
+    if(!_ezGraver || (_jogX == 0 && _jogY == 0)) {
+        _jogTimer.stop();
+        return;
+    }
+    if(_ezGraver->pendingSteps() > 0) {
+        return;
+    }
+
+    _ezGraver->moveBy(_jogX, _jogY);
+    _jogX = 0;
+    _jogY = 0;
+}
+
+void MainWindow::_flushJog() {
+    // Steps still accumulating are sent at once, the engraver queues the next command behind them.
+    _jogTimer.stop();
+    if(_jogX != 0 || _jogY != 0) {
+        _ezGraver->moveBy(_jogX, _jogY);
+    }
+    _jogX = 0;
+    _jogY = 0;
+}
+
+void MainWindow::_cancelJog() {
+    _jogTimer.stop();
+    _jogX = 0;
+    _jogY = 0;
 }
 
 void MainWindow::on_upload_clicked() {
+    _uploadedBitmap = _ui->image->bitmap();
+    _uploadedStats = _ui->image->stats();
+    _burnProgress.reset();
+    _ui->image->resetBurnStatus();
+    _eraseAndUpload(_uploadedBitmap, false);
+}
+
+void MainWindow::on_resume_clicked() {
+    auto const residual = _burnProgress.residual(_uploadedBitmap);
+    auto const stats = BitmapStats::analyze(residual);
+    if(stats.burnCount == 0) {
+        _printVerbose("nothing left to burn");
+        return;
+    }
+
+    auto const seconds = qRound(_ui->image->estimator().estimate(stats, _ui->burnTime->value()));
+    auto const question = QString{"%1 pixels have already been burned. Erase the EEPROM and upload the remaining %2 pixels, "
+                                  "taking about %3:%4?"}
+            .arg(_burnProgress.count()).arg(stats.burnCount)
+            .arg(seconds / 60).arg(seconds % 60, 2, 10, QChar{'0'});
+    if(QMessageBox::question(this, "Resume", question) != QMessageBox::Yes) {
+        return;
+    }
+
+    _printVerbose(QString{"resuming with %1 remaining pixels"}.arg(stats.burnCount));
+    _uploadedStats = stats;
+    _eraseAndUpload(residual, true);
+}
+
+void MainWindow::_eraseAndUpload(QImage const& bitmap, bool resume) {
+    _jobStarted = false;
     _printVerbose("erasing EEPROM");
+    _flushJog();
     _ezGraver->erase();
 
-    QImage image{_ui->image->pixmap()->toImage()};
     QTimer* eraseProgressTimer{new QTimer{this}};
     _ui->progress->setValue(0);
     _ui->progress->setMaximum(EzGraver::EraseTimeMs);
-    _ui->image->resetBurnStatus();
 
-    auto eraseProgress = std::bind(&MainWindow::_eraseProgressed, this, eraseProgressTimer, image);
+    auto eraseProgress = std::bind(&MainWindow::_eraseProgressed, this, eraseProgressTimer, bitmap, resume);
     connect(eraseProgressTimer, &QTimer::timeout, eraseProgress);
     eraseProgressTimer->start(EraseProgressDelay);
 }
 
-void MainWindow::_eraseProgressed(QTimer* eraseProgressTimer, QImage const& image) {
+void MainWindow::_eraseProgressed(QTimer* eraseProgressTimer, QImage const& bitmap, bool resume) {
     auto value = _ui->progress->value() + EraseProgressDelay;
     _ui->progress->setValue(value);
     if(value < EzGraver::EraseTimeMs) {
@@ -211,10 +455,10 @@ void MainWindow::_eraseProgressed(QTimer* eraseProgressTimer, QImage const& imag
     }
     eraseProgressTimer->stop();
 
-    _uploadImage(image);
+    _uploadBitmap(bitmap, resume);
 }
 
-void MainWindow::_uploadImage(QImage const& image) {
+void MainWindow::_uploadBitmap(QImage const& bitmap, bool resume) {
     _bytesWrittenProcessor = std::bind(&MainWindow::updateProgress, this, std::placeholders::_1);
     if (_ui->image->picW() <= 0 )
     {
@@ -222,53 +466,150 @@ void MainWindow::_uploadImage(QImage const& image) {
         return;
     }
     _printVerbose("uploading image to EEPROM");
-    auto bytes = _ezGraver->uploadImage(image);
+    auto bytes = _ezGraver->uploadBitmap(bitmap);
     int maxProgress = _ui->image->burnCount();
     if (maxProgress == 0)
         maxProgress = EzGraver::ImageWidth * EzGraver::ImageHeight;
     _ui->progress->setMaximum(maxProgress);
     _ui->progress->setValue(bytes);
-    _ui->image->resetBurnStatus();
+    // Pixels burned before an interruption stay marked, so the progress continues where it stopped.
+    if(!resume) {
+        _ui->image->resetBurnStatus();
+    }
+    // The request is queued behind the paced upload, so it is only answered once the whole image arrived.
     _ezGraver->requestReady();
 }
 
 void MainWindow::on_preview_clicked() {
     _printVerbose("drawing preview");
+    _flushJog();
     _ezGraver->preview();
 }
 
 void MainWindow::on_start_clicked() {
     _printVerbose(QString{"starting engrave process with burn time %1"}.arg(_ui->burnTime->value()));
     _ui->progress->setValue(0);
+    // Resuming a paused job continues its log, only the first start of a job begins a new one.
+    if(!_jobStarted) {
+        _telemetry.start(_ui->burnTime->value());
+        _jobStarted = true;
+        _jobPaused = false;
+    }
+    _flushJog();
     _ezGraver->start(_ui->burnTime->value());
 }
 
 void MainWindow::on_pause_clicked() {
     _printVerbose("pausing engrave process");
+    _jobPaused = _jobStarted;
+    _flushJog();
     _ezGraver->pause();
 }
 
 void MainWindow::on_reset_clicked() {
+    // The burned pixels are kept, so the job can be resumed afterwards.
     _printVerbose("resetting engraver");
-    _ui->image->resetBurnStatus();
+    _cancelJog();
+    _jobStarted = false;
     _ezGraver->reset();
 }
 
 void MainWindow::on_disconnect_clicked() {
     _printVerbose("disconnecting");
+    _reportTimer.stop();
+    _cancelJog();
     _setConnected(false);
     _ezGraver.reset();
     _printVerbose("disconnected");
 }
 
 void MainWindow::on_image_clicked() {
-    auto fileName = QFileDialog::getOpenFileName(this, "Open Image", "", "Images (*.png *.jpeg *.jpg *.bmp)");
+    auto fileName = QFileDialog::getOpenFileName(this, "Open Image", "", ImageLoader::nameFilter());
     if(!fileName.isNull()) {
         _loadImage(fileName);
         emit uploadedChanged(false);
     }
 }
 
+void MainWindow::on_compare_clicked() {
+    CompareDialog dialog{_ui->image->adjustedImage(), _ui->image->edgeSettings(), _ui->image->thresholdSettings(), this};
+    if(dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    auto const candidate = dialog.selected();
+    _printVerbose(QString{"selected conversion: %1"}.arg(candidate.name));
+    for(int i{0}; i < _ui->conversionFlags->count(); ++i) {
+        if(_ui->conversionFlags->itemData(i, ConversionModeRole).toInt() == candidate.settings.mode
+                && _ui->conversionFlags->itemData(i).toInt() == static_cast<int>(candidate.settings.flags)) {
+            _ui->conversionFlags->setCurrentIndex(i);
+            break;
+        }
+    }
+    _ui->brightness->setValue(_ui->brightness->value() + candidate.brightness);
+}
+
+void MainWindow::on_telemetry_clicked() {
+    if(!_telemetryDialog) {
+        _telemetryDialog = new TelemetryDialog{_telemetry, this};
+    }
+    _telemetryDialog->show();
+    _telemetryDialog->raise();
+}
+
+void MainWindow::on_nest_clicked() {
+    BinarizerSettings binarizer{};
+    binarizer.mode = _ui->image->conversionMode();
+    binarizer.flags = _ui->image->conversionFlags();
+    binarizer.edges = _ui->image->edgeSettings();
+    binarizer.threshold = _ui->image->thresholdSettings();
+
+    auto const filters = _ui->image->filtersEnabled() ? &_ui->image->filters() : NULL;
+    NestDialog dialog{_ui->image->tone(), filters, binarizer, this};
+    if(dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    _printVerbose("nested designs onto one canvas");
+    _ui->image->setRaster(dialog.raster());
+}
+
+void MainWindow::on_optimizeLayout_clicked() {
+    auto const bitmap = _ui->image->bitmap();
+    if(bitmap.isNull()) {
+        return;
+    }
+
+    // The displayed raster is the device bitmap mirrored back, with black pixels being burned.
+    QImage raster{bitmap.mirrored()};
+    raster.invertPixels();
+    auto const candidates = LayoutOptimizer::evaluate(raster, _ui->burnTime->value(), _ui->image->estimator());
+    if(candidates.isEmpty()) {
+        _printVerbose("nothing to burn, layout not optimized");
+        return;
+    }
+
+    auto const& current = candidates.first();
+    auto const& layout = candidates[LayoutOptimizer::fastest(candidates)];
+    if(layout.seconds >= current.seconds) {
+        _printVerbose(QString{"the current layout is already the fastest with about %1 s"}.arg(qRound(current.seconds)));
+        return;
+    }
+
+    auto const saving = current.seconds - layout.seconds;
+    auto const question = QString{"Rotating the design by %1 degrees and moving it to %2, %3 reduces the predicted burn time "
+                                  "from %4 s to %5 s, saving %6 s (%7%). Apply the layout?"}
+            .arg(layout.quarterTurns * 90).arg(layout.position.x()).arg(layout.position.y())
+            .arg(qRound(current.seconds)).arg(qRound(layout.seconds))
+            .arg(qRound(saving)).arg(qRound(100 * saving / current.seconds));
+    if(QMessageBox::question(this, "Optimize Layout", question) != QMessageBox::Yes) {
+        return;
+    }
+
+    _printVerbose(QString{"optimized layout, saving about %1 s"}.arg(qRound(saving)));
+    _ui->image->setRaster(LayoutOptimizer::render(raster, layout));
+}
+
 void MainWindow::dragEnterEvent(QDragEnterEvent* event) {
     if(event->mimeData()->hasUrls() && event->mimeData()->urls().count() == 1) {
         event->acceptProposedAction();
@@ -280,48 +621,43 @@ void MainWindow::dropEvent(QDropEvent* event) {
     _loadImage(fileName);
 }
 
-void MainWindow::readyRead()
+void MainWindow::drainReports()
 {
-    _inData += _ezGraver->serialPort()->read(1024);
     bool marked = false;
-    for (int i = 0; _inData.size() > 0; ++i)
+    auto const reports = _ezGraver->readReports();
+    _telemetry.record(reports);
+    for (auto const& report : reports)
     {
-        if ((_inData.size() >= 5) && (_inData[0] == '\xff'))
+        switch (report.type)
         {
-            // Report about burned pixel
-            int pic_x = (_inData[1]*100 + _inData[2]);
-            int pic_y = (_inData[3]*100 + _inData[4]);
-            _ui->progress->setValue( _ui->image->markBurnedPixel( pic_x, pic_y ) );
+        case Report::BurnedPixel:
+            _ui->progress->setValue( _ui->image->markBurnedPixel( report.x, report.y ) );
+            _burnProgress.mark(report.x, report.y);
             marked = true;
-            _inData.remove(0, 5);
-        } else
-        if ((_inData.size() > 0) && (_inData[0] == '\x66'))
-        {
-            // Report about complete burning
+            break;
+        case Report::Complete:
             _printVerbose("status - complete");
+            // The elapsed time of a paused job includes the pause, so only jobs burned in one run calibrate the estimate.
+            if(_telemetry.burnTime() > 0 && !_jobPaused) {
+                _ui->image->estimator().addJob(_uploadedStats, _telemetry.burnTime(), _telemetry.elapsed() / 1000.0);
+                _updateEstimate();
+            }
+            _jobStarted = false;
             _ui->progress->setValue(0);
             _ui->image->resetBurnStatus();
-            _inData.remove(0, 1);
-        } else
-        if ((_inData.size() > 0) && (_inData[0] == '\x65'))
-        {
-            // Ready status
+            _burnProgress.reset();
+            enableControls();
+            break;
+        case Report::Ready:
             _printVerbose("status - ready");
             _ui->progress->setValue(0);
             _setUploaded(true);
-            _inData.remove(0, 1);
-        } else
-        {
-            if (i == 0)
-            {
-                qDebug() << "received unknown data" << _inData.size() << " bytes: " << _inData.toHex();
-                _inData.clear();
-            }
             break;
         }
     }
 
-    if (marked)
+    if (marked) {
         _ui->image->updateInfoLayers();
+        _ui->resume->setEnabled(_connected && !_uploadedBitmap.isNull());
+    }
 }
-
@@ -8,6 +8,12 @@
 #include <functional>
 
 #include "ezgraver.h"
+#include "portwatcher.h"
+#include "binarizer.h"
+#include "burntelemetry.h"
+#include "burnprogress.h"
+
+class TelemetryDialog;
 
 namespace Ui {
 class MainWindow;
@@ -37,17 +43,22 @@ private slots:
     void on_right_clicked();
     void on_down_clicked();
     void on_upload_clicked();
+    void on_resume_clicked();
     void on_preview_clicked();
     void on_start_clicked();
     void on_pause_clicked();
     void on_reset_clicked();
     void on_disconnect_clicked();
     void on_image_clicked();
+    void on_compare_clicked();
+    void on_telemetry_clicked();
+    void on_nest_clicked();
+    void on_optimizeLayout_clicked();
 
-    void updatePorts();
+    void updatePorts(QStringList const& ports);
     void bytesWritten(qint64 bytes);
     void updateProgress(qint64 bytes);
-    void readyRead();
+    void drainReports();
     void enableControls();
 
 protected:
@@ -55,29 +66,54 @@ protected:
     void dropEvent(QDropEvent* event);
 
 private:
-    /*! The delay between each port list update. */
-    static int const PortUpdateDelay{1000};
     /*! The delay between each progress update while erasing the EEPROM. */
     static int const EraseProgressDelay{500};
+    /*! The delay between draining the reports decoded by the I/O thread, about once per frame. */
+    static int const ReportDrainDelay{16};
+    /*! The item data role of the conversion combo box holding the conversion mode. */
+    static int const ConversionModeRole{Qt::UserRole + 1};
+    /*! The delay between checking if the previous move has been handed over, in order to send the next one. */
+    static int const JogDelay{50};
 
     Ui::MainWindow* _ui;
-    QTimer _portTimer;
-    QByteArray _inData;
+    PortWatcher _portWatcher;
+    QTimer _reportTimer;
+    QTimer _jogTimer;
 
     std::shared_ptr<EzGraver> _ezGraver;
     std::function<void(qint64)> _bytesWrittenProcessor;
     bool _connected;
     bool _uploaded;
+    bool _jobStarted;
+    bool _jobPaused;
+    BurnTelemetry _telemetry;
+    TelemetryDialog* _telemetryDialog;
+    BitmapStats _uploadedStats;
+    QImage _uploadedBitmap;
+    BurnProgress _burnProgress;
+    int _jogX;
+    int _jogY;
 
     void _initBindings();
     void _initConversionFlags();
-
+    void _addConversionMode(QString const& name, BinarizerSettings::Mode mode, Qt::ImageConversionFlags flags);
+    void _initToneBindings();
+    void _initBudgetBindings();
+    void _initJogBindings();
+    void _initFilters();
+
+    void _updateEstimate();
+    void _jog(int dx, int dy);
+    void _sendJog();
+    void _flushJog();
+    void _cancelJog();
     void _setConnected(bool connected);
     void _setUploaded(bool uploaded);
     void _printVerbose(QString const& verbose);
     void _loadImage(QString const& fileName);
-    void _eraseProgressed(QTimer* eraseProgressTimer, QImage const& image);
-    void _uploadImage(QImage const& image);
+    void _eraseAndUpload(QImage const& bitmap, bool resume);
+    void _eraseProgressed(QTimer* eraseProgressTimer, QImage const& bitmap, bool resume);
+    void _uploadBitmap(QImage const& bitmap, bool resume);
 };
 
 #endif // MAINWINDOW_H
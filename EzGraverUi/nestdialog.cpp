@@ -0,0 +1,163 @@
+#include "nestdialog.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QListWidget>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QPainter>
+#include <QLabel>
+#include <QSet>
+
+#include <numeric>
+
+#include "imageloader.h"
+
+namespace {
+
+/*! Converts a single design fitted into a square of the given size. */
+QImage convertPiece(QString const& fileName, int size, ToneSettings const& tone, FilterPipeline const* filters,
+                    BinarizerSettings const& binarizer) {
+    auto image = ImageLoader::load(fileName, QSize{size, size});
+    if(image.isNull()) {
+        return QImage{};
+    }
+
+    auto scaled = image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QImage piece{scaled.size(), QImage::Format_ARGB32};
+    piece.fill(Qt::white);
+    QPainter painter{&piece};
+    painter.drawImage(0, 0, scaled);
+    painter.end();
+
+    auto const adjusted = tone.isIdentity() ? piece : Tone::apply(piece, tone);
+    return Binarizer::apply(filters ? filters->apply(adjusted) : adjusted, binarizer);
+}
+
+}
+
+NestDialog::NestDialog(ToneSettings const& tone, FilterPipeline const* filters, BinarizerSettings const& binarizer,
+                       QWidget* parent)
+    : QDialog{parent}, _tone(tone), _filters{filters}, _binarizer(binarizer), _files{new QListWidget{}}, _copies{new QSpinBox{}},
+      _pieceSize{new QSpinBox{}}, _spacing{new QSpinBox{}}, _rotation{new QCheckBox{"Allow rotation"}},
+      _nest{new QPushButton{"Nest"}}, _preview{new QLabel{}}, _status{new QLabel{}},
+      _buttons{new QDialogButtonBox{QDialogButtonBox::Ok | QDialogButtonBox::Cancel}}, _watcher{}, _raster{} {
+    setWindowTitle("Nest Designs");
+
+    _copies->setRange(1, 256);
+    _pieceSize->setRange(16, 512);
+    _pieceSize->setValue(128);
+    _pieceSize->setSuffix(" px");
+    _spacing->setRange(0, 64);
+    _spacing->setValue(4);
+    _spacing->setSuffix(" px");
+    _rotation->setChecked(true);
+    _preview->setFixedSize(PreviewSize, PreviewSize);
+    _preview->setFrameShape(QFrame::Box);
+    _buttons->button(QDialogButtonBox::Ok)->setEnabled(false);
+
+    auto add = new QPushButton{"Add..."};
+    auto remove = new QPushButton{"Remove"};
+    auto fileButtons = new QHBoxLayout{};
+    fileButtons->addWidget(add);
+    fileButtons->addWidget(remove);
+
+    auto form = new QFormLayout{};
+    form->addRow("Copies of each design", _copies);
+    form->addRow("Piece size", _pieceSize);
+    form->addRow("Spacing", _spacing);
+    form->addRow(_rotation);
+
+    auto left = new QVBoxLayout{};
+    left->addWidget(_files);
+    left->addLayout(fileButtons);
+    left->addLayout(form);
+    left->addWidget(_nest);
+
+    auto right = new QVBoxLayout{};
+    right->addWidget(_preview);
+    right->addWidget(_status);
+    right->addStretch();
+
+    auto content = new QHBoxLayout{};
+    content->addLayout(left);
+    content->addLayout(right);
+
+    auto layout = new QVBoxLayout{this};
+    layout->addLayout(content);
+    layout->addWidget(_buttons);
+
+    connect(add, &QPushButton::clicked, [this] { _addFiles(); });
+    connect(remove, &QPushButton::clicked, [this] { qDeleteAll(_files->selectedItems()); });
+    connect(_nest, &QPushButton::clicked, [this] { _startNesting(); });
+    connect(&_watcher, &QFutureWatcher<NestResult>::finished, [this] { _nested(); });
+    connect(_buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(_buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+NestDialog::~NestDialog() {
+    _watcher.waitForFinished();
+}
+
+QImage NestDialog::raster() const {
+    return _raster;
+}
+
+void NestDialog::_addFiles() {
+    auto fileNames = QFileDialog::getOpenFileNames(this, "Add Designs", "", ImageLoader::nameFilter());
+    _files->addItems(fileNames);
+}
+
+void NestDialog::_startNesting() {
+    QStringList fileNames{};
+    for(int i{0}; i < _files->count(); ++i) {
+        for(int copy{0}; copy < _copies->value(); ++copy) {
+            fileNames.append(_files->item(i)->text());
+        }
+    }
+    if(fileNames.isEmpty()) {
+        return;
+    }
+
+    _nest->setEnabled(false);
+    _buttons->button(QDialogButtonBox::Ok)->setEnabled(false);
+    _status->setText("Nesting...");
+
+    auto const size = _pieceSize->value();
+    auto const spacing = _spacing->value();
+    auto const rotation = _rotation->isChecked();
+    auto const tone = _tone;
+    auto const filters = _filters;
+    auto const binarizer = _binarizer;
+    _watcher.setFuture(QtConcurrent::run([fileNames, size, spacing, rotation, tone, filters, binarizer] {
+        // Copies of a design are converted once and shared.
+        auto const unique = fileNames.toSet().toList();
+        QVector<QImage> converted(unique.size());
+        QVector<int> indexes(unique.size());
+        std::iota(indexes.begin(), indexes.end(), 0);
+        QtConcurrent::blockingMap(indexes, [&](int const& i) {
+            converted[i] = convertPiece(unique[i], size, tone, filters, binarizer);
+        });
+
+        QVector<QImage> pieces{};
+        for(auto const& fileName : fileNames) {
+            pieces.append(converted[unique.indexOf(fileName)]);
+        }
+        return Nesting::nest(pieces, spacing, rotation);
+    }));
+}
+
+void NestDialog::_nested() {
+    auto const result = _watcher.result();
+    _raster = result.raster;
+    _preview->setPixmap(QPixmap::fromImage(_raster.scaled(PreviewSize, PreviewSize, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
+    _status->setText(QString{"%1 pieces placed, %2 did not fit"}.arg(result.placements.size()).arg(result.unplaced.size()));
+    _nest->setEnabled(true);
+    _buttons->button(QDialogButtonBox::Ok)->setEnabled(!result.placements.isEmpty());
+}
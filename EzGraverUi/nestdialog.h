@@ -0,0 +1,75 @@
+#ifndef NESTDIALOG_H
+#define NESTDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+
+#include "nesting.h"
+#include "binarizer.h"
+#include "tone.h"
+#include "filterpipeline.h"
+
+class QListWidget;
+class QSpinBox;
+class QCheckBox;
+class QLabel;
+class QPushButton;
+class QDialogButtonBox;
+
+/*!
+ * Nests several small designs onto one canvas, so they are engraved as a single job.
+ * Every design is converted with the current settings at the chosen piece size.
+ */
+class NestDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    /*! The size of the preview in pixels. */
+    static int const PreviewSize{256};
+
+    /*!
+     * Creates a new dialog.
+     *
+     * \param tone The tone settings the designs are adjusted with.
+     * \param filters The filter stages applied after the tone adjustment or \c NULL if disabled,
+     *        must outlive the dialog.
+     * \param binarizer The settings the designs are converted with.
+     * \param parent The parent of the dialog.
+     */
+    explicit NestDialog(ToneSettings const& tone, FilterPipeline const* filters, BinarizerSettings const& binarizer,
+                        QWidget* parent=NULL);
+
+    /*!
+     * Waits for the nesting to finish upon deconstruction.
+     */
+    virtual ~NestDialog();
+
+    /*!
+     * Gets the nested designs.
+     *
+     * \return The composite in the format \c QImage::Format_Mono with black pixels to be burned.
+     */
+    QImage raster() const;
+
+private:
+    ToneSettings _tone;
+    FilterPipeline const* _filters;
+    BinarizerSettings _binarizer;
+    QListWidget* _files;
+    QSpinBox* _copies;
+    QSpinBox* _pieceSize;
+    QSpinBox* _spacing;
+    QCheckBox* _rotation;
+    QPushButton* _nest;
+    QLabel* _preview;
+    QLabel* _status;
+    QDialogButtonBox* _buttons;
+    QFutureWatcher<NestResult> _watcher;
+    QImage _raster;
+
+    void _addFiles();
+    void _startNesting();
+    void _nested();
+};
+
+#endif // NESTDIALOG_H
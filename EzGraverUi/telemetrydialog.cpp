@@ -0,0 +1,63 @@
+#include "telemetrydialog.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QLabel>
+
+#include "telemetrywidget.h"
+
+TelemetryDialog::TelemetryDialog(BurnTelemetry const& telemetry, QWidget* parent)
+    : QDialog{parent}, _telemetry(telemetry), _widget{new TelemetryWidget{telemetry}}, _summary{new QLabel{}}, _refreshTimer{} {
+    setWindowTitle("Burn Telemetry");
+
+    auto exportButton = new QPushButton{"Export..."};
+    connect(exportButton, &QPushButton::clicked, this, &TelemetryDialog::exportLog);
+
+    auto footer = new QHBoxLayout{};
+    footer->addWidget(_summary, 1);
+    footer->addWidget(exportButton);
+
+    auto layout = new QVBoxLayout{this};
+    layout->addWidget(_widget, 1);
+    layout->addLayout(footer);
+
+    connect(&_refreshTimer, &QTimer::timeout, this, &TelemetryDialog::refresh);
+}
+
+TelemetryDialog::~TelemetryDialog() {}
+
+void TelemetryDialog::refresh() {
+    auto const gaps = _telemetry.gaps();
+    _summary->setText(QString{"%1 px burned at %2 px/s, gaps %3 ms mean, %4 ms median, %5 ms max, %6 stalls"}
+            .arg(_telemetry.samples().size())
+            .arg(_telemetry.burnRate(), 0, 'f', 1)
+            .arg(gaps.mean, 0, 'f', 1)
+            .arg(gaps.median)
+            .arg(gaps.max)
+            .arg(_telemetry.stalls().size()));
+    _widget->update();
+}
+
+void TelemetryDialog::exportLog() {
+    auto fileName = QFileDialog::getSaveFileName(this, "Export Telemetry", "", "CSV (*.csv);;JSON (*.json)");
+    if(fileName.isEmpty()) {
+        return;
+    }
+    if(!_telemetry.save(fileName)) {
+        QMessageBox::warning(this, "Export Telemetry", QString{"Failed to write '%1'."}.arg(fileName));
+    }
+}
+
+void TelemetryDialog::showEvent(QShowEvent* event) {
+    QDialog::showEvent(event);
+    refresh();
+    _refreshTimer.start(RefreshDelay);
+}
+
+void TelemetryDialog::hideEvent(QHideEvent* event) {
+    _refreshTimer.stop();
+    QDialog::hideEvent(event);
+}
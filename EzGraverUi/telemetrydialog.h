@@ -0,0 +1,57 @@
+#ifndef TELEMETRYDIALOG_H
+#define TELEMETRYDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+#include "burntelemetry.h"
+
+class QLabel;
+class TelemetryWidget;
+
+/*!
+ * Shows the live telemetry of the current job and allows exporting its log.
+ */
+class TelemetryDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    /*! The delay between two refreshes while the dialog is visible. */
+    static int const RefreshDelay{500};
+
+    /*!
+     * Creates a new dialog showing the given \a telemetry.
+     *
+     * \param telemetry The telemetry to show, has to outlive the dialog.
+     * \param parent The parent of the dialog.
+     */
+    explicit TelemetryDialog(BurnTelemetry const& telemetry, QWidget* parent=NULL);
+
+    /*!
+     * Frees all required resources upon deconstruction.
+     */
+    virtual ~TelemetryDialog();
+
+public slots:
+    /*!
+     * Updates the chart and the summary.
+     */
+    void refresh();
+
+    /*!
+     * Asks for a file and exports the log as CSV or JSON.
+     */
+    void exportLog();
+
+protected:
+    void showEvent(QShowEvent* event);
+    void hideEvent(QHideEvent* event);
+
+private:
+    BurnTelemetry const& _telemetry;
+    TelemetryWidget* _widget;
+    QLabel* _summary;
+    QTimer _refreshTimer;
+};
+
+#endif // TELEMETRYDIALOG_H
@@ -0,0 +1,88 @@
+#include "telemetrywidget.h"
+
+#include <QPainter>
+#include <QPolygonF>
+
+#include <algorithm>
+
+#include "ezgraver.h"
+
+TelemetryWidget::TelemetryWidget(BurnTelemetry const& telemetry, QWidget* parent)
+    : QWidget{parent}, _telemetry(telemetry) {
+    setMinimumSize(480, 200);
+}
+
+TelemetryWidget::~TelemetryWidget() {}
+
+QSize TelemetryWidget::sizeHint() const {
+    return QSize{720, 260};
+}
+
+void TelemetryWidget::paintEvent(QPaintEvent*) {
+    QPainter painter{this};
+    painter.fillRect(rect(), palette().base());
+
+    // The heatmap is quadratic like the engraving area, the chart takes the remaining width.
+    auto const side = height() - 20;
+    _paintChart(painter, QRect{10, 10, width() - side - 30, side});
+    _paintHeatmap(painter, QRect{width() - side - 10, 10, side, side});
+}
+
+void TelemetryWidget::_paintChart(QPainter& painter, QRect const& area) const {
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(area);
+
+    auto const rates = _telemetry.rateSeries(BucketMs);
+    if(rates.isEmpty()) {
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(area, Qt::AlignCenter, "No pixels burned yet");
+        return;
+    }
+
+    auto const maxRate = std::max(1.0, *std::max_element(rates.begin(), rates.end()));
+    auto const step = rates.size() > 1 ? static_cast<double>(area.width()) / (rates.size() - 1) : 0.0;
+    auto point = [&](int i) {
+        return QPointF{area.left() + i * step, area.bottom() - rates[i] / maxRate * area.height()};
+    };
+
+    // Stalls are marked where they began.
+    painter.setPen(QPen{QColor{0xFF, 0x00, 0x00, 0x80}});
+    auto const duration = static_cast<double>(rates.size() * BucketMs);
+    for(auto const& stall : _telemetry.stalls()) {
+        auto const x = area.left() + stall.start / duration * area.width();
+        painter.drawLine(QPointF{x, static_cast<double>(area.top())}, QPointF{x, static_cast<double>(area.bottom())});
+    }
+
+    QPolygonF line{};
+    for(int i{0}; i < rates.size(); ++i) {
+        line << point(i);
+    }
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen{palette().color(QPalette::Highlight), 2});
+    painter.drawPolyline(line);
+    painter.setRenderHint(QPainter::Antialiasing, false);
+
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(area.adjusted(4, 2, -4, -2), Qt::AlignTop | Qt::AlignLeft, QString{"%1 px/s"}.arg(maxRate, 0, 'f', 0));
+    painter.drawText(area.adjusted(4, 2, -4, -2), Qt::AlignBottom | Qt::AlignRight, QString{"%1 s"}.arg(rates.size() * BucketMs / 1000));
+}
+
+void TelemetryWidget::_paintHeatmap(QPainter& painter, QRect const& area) const {
+    auto const columns = (EzGraver::ImageWidth + CellSize - 1) / CellSize;
+    auto const rows = (EzGraver::ImageHeight + CellSize - 1) / CellSize;
+    auto const dwell = _telemetry.dwellMap(CellSize);
+    auto const maxDwell = std::max<qint64>(1, *std::max_element(dwell.begin(), dwell.end()));
+
+    // Each cell is rendered as a single pixel and scaled up, white meaning no time spent.
+    QImage heatmap{columns, rows, QImage::Format_RGB32};
+    for(int row{0}; row < rows; ++row) {
+        for(int column{0}; column < columns; ++column) {
+            auto const level = 255 - static_cast<int>(dwell[row * columns + column] * 255 / maxDwell);
+            heatmap.setPixel(column, row, qRgb(255, level, level));
+        }
+    }
+    painter.drawImage(area, heatmap);
+
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(area);
+}
@@ -0,0 +1,47 @@
+#ifndef TELEMETRYWIDGET_H
+#define TELEMETRYWIDGET_H
+
+#include <QtWidgets/QWidget>
+
+#include "burntelemetry.h"
+
+/*!
+ * Paints the burn rate of a job over time along with a heatmap of the time spent
+ * per area of the engraving area.
+ */
+class TelemetryWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    /*! The duration each point of the burn rate chart covers in milliseconds. */
+    static int const BucketMs{1000};
+
+    /*! The edge length in pixels of each area of the heatmap. */
+    static int const CellSize{16};
+
+    /*!
+     * Creates a new instance showing the given \a telemetry.
+     *
+     * \param telemetry The telemetry to show, has to outlive the widget.
+     * \param parent The parent of the widget.
+     */
+    explicit TelemetryWidget(BurnTelemetry const& telemetry, QWidget* parent=NULL);
+
+    /*!
+     * Frees all required resources upon deconstruction.
+     */
+    virtual ~TelemetryWidget();
+
+    QSize sizeHint() const;
+
+protected:
+    void paintEvent(QPaintEvent* event);
+
+private:
+    BurnTelemetry const& _telemetry;
+
+    void _paintChart(QPainter& painter, QRect const& area) const;
+    void _paintHeatmap(QPainter& painter, QRect const& area) const;
+};
+
+#endif // TELEMETRYWIDGET_H
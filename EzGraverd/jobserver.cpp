@@ -0,0 +1,375 @@
+#include "jobserver.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QFileInfo>
+#include <QTimer>
+#include <QDebug>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "imageloader.h"
+
+QString const JobServer::DefaultSocketName{"ezgraverd"};
+
+namespace {
+
+/*! The minimal delay in milliseconds between two progress events of a job. */
+int const ProgressEventDelay{250};
+
+/*! The number of finished jobs kept to be queried, older ones are dropped. */
+int const MaxFinishedJobs{256};
+
+/*! The time in milliseconds to wait for a daemon already listening on the socket. */
+int const ProbeTimeout{1000};
+
+bool isFinal(QString const& state) {
+    return state == "completed" || state == "cancelled" || state == "failed";
+}
+
+}
+
+JobServer::JobServer(QObject* parent)
+        : QObject{parent}, _server{}, _clients{}, _jobs{}, _engravers{}, _portWatcher{}, _folderWatcher{}, _watchPorts{},
+          _watchBurnTime{60}, _nextId{1} {
+    connect(&_server, &QLocalServer::newConnection, this, &JobServer::_newConnection);
+    connect(&_portWatcher, &PortWatcher::portAdded, this, [this](QString const& port) { _portChanged(port, true); });
+    connect(&_portWatcher, &PortWatcher::portRemoved, this, [this](QString const& port) { _portChanged(port, false); });
+}
+
+JobServer::~JobServer() {
+    for(auto const& job : _jobs) {
+        if(job->runner) {
+            job->runner->cancel();
+        }
+    }
+}
+
+bool JobServer::listen(QString const& name) {
+    // Only a socket left behind by a crashed daemon is removed, a running daemon keeps its socket.
+    QLocalSocket probe{};
+    probe.connectToServer(name);
+    if(probe.waitForConnected(ProbeTimeout)) {
+        qDebug() << "another daemon is already listening on" << name;
+        return false;
+    }
+    QLocalServer::removeServer(name);
+    if(!_server.listen(name)) {
+        qDebug() << "failed to listen on" << name << _server.errorString();
+        return false;
+    }
+    qDebug() << "listening on" << _server.fullServerName();
+    return true;
+}
+
+bool JobServer::watch(QString const& directory, QStringList const& ports, int burnTime) {
+    _folderWatcher.reset(new FolderWatcher{directory});
+    _watchPorts = ports;
+    _watchBurnTime = burnTime;
+    connect(_folderWatcher.get(), &FolderWatcher::fileReady, this, [this](QString const& fileName) {
+        _enqueue(QString{}, fileName, _watchBurnTime, 0, true);
+    });
+    return _folderWatcher->start();
+}
+
+void JobServer::_newConnection() {
+    while(_server.hasPendingConnections()) {
+        auto client = _server.nextPendingConnection();
+        _clients.append(client);
+        connect(client, &QLocalSocket::readyRead, this, [this, client] { _readClient(client); });
+        connect(client, &QLocalSocket::disconnected, this, [this, client] {
+            _clients.removeAll(client);
+            client->deleteLater();
+        });
+    }
+}
+
+void JobServer::_readClient(QLocalSocket* client) {
+    while(client->canReadLine()) {
+        QJsonParseError error{};
+        auto document = QJsonDocument::fromJson(client->readLine(), &error);
+        if(error.error != QJsonParseError::NoError || !document.isObject()) {
+            _send(client, QJsonObject{{"reply", "error"}, {"message", "malformed request"}});
+            continue;
+        }
+        _send(client, _handleRequest(document.object()));
+    }
+}
+
+QJsonObject JobServer::_handleRequest(QJsonObject const& request) {
+    auto command = request["command"].toString();
+    if(command == "submit") {
+        return _submit(request);
+    } else if(command == "cancel") {
+        return _cancel(request);
+    } else if(command == "query") {
+        return _query(request);
+    } else if(command == "ports") {
+        return _ports();
+    }
+    return QJsonObject{{"reply", "error"}, {"message", QString{"unknown command '%1'"}.arg(command)}};
+}
+
+QJsonObject JobServer::_submit(QJsonObject const& request) {
+    auto fileName = request["image"].toString();
+    auto port = request["port"].toString();
+    auto burnTime = request["burnTime"].toInt(60);
+    if(port.isEmpty() || !QFileInfo{fileName}.isFile()) {
+        return QJsonObject{{"reply", "error"}, {"message", "a port and an existing image are required"}};
+    }
+    if(burnTime < 1 || burnTime > 0xF0) {
+        return QJsonObject{{"reply", "error"}, {"message", "burn time out of range"}};
+    }
+
+    auto job = _enqueue(port, fileName, burnTime, request["priority"].toInt(0), false);
+    return QJsonObject{{"reply", "submit"}, {"id", job->id}};
+}
+
+std::shared_ptr<JobServer::Job> JobServer::_enqueue(QString const& port, QString const& fileName, int burnTime, int priority, bool watched) {
+    std::shared_ptr<Job> job{new Job{_nextId++, port, fileName, burnTime, priority, QString{}, QString{}, QImage{},
+            std::make_shared<QFutureWatcher<QImage>>(), nullptr, watched, QDateTime::currentDateTime(), QJsonObject{}}};
+    _jobs.insert(job->id, job);
+    _setState(job, "preprocessing");
+
+    connect(job->preprocessing.get(), &QFutureWatcher<QImage>::finished, this, [this, job] { _preprocessed(job); });
+    job->preprocessing->setFuture(QtConcurrent::run([fileName] {
+        auto image = ImageLoader::load(fileName);
+        return image.isNull() ? QImage{} : EzGraver::convertImage(image);
+    }));
+    return job;
+}
+
+QJsonObject JobServer::_cancel(QJsonObject const& request) {
+    auto job = _jobs.value(request["id"].toInt(), nullptr);
+    if(!job || isFinal(job->state)) {
+        return QJsonObject{{"reply", "cancel"}, {"id", request["id"]}, {"success", false}};
+    }
+
+    if(job->runner) {
+        job->runner->cancel();
+    } else {
+        _setState(job, "cancelled");
+    }
+    return QJsonObject{{"reply", "cancel"}, {"id", job->id}, {"success", true}};
+}
+
+QJsonObject JobServer::_query(QJsonObject const& request) const {
+    QJsonArray jobs{};
+    for(auto const& job : _jobs) {
+        if(!request.contains("id") || request["id"].toInt() == job->id) {
+            jobs.append(_describe(*job));
+        }
+    }
+    return QJsonObject{{"reply", "query"}, {"jobs", jobs}};
+}
+
+QJsonObject JobServer::_ports() const {
+    return QJsonObject{{"reply", "ports"}, {"ports", QJsonArray::fromStringList(_portWatcher.ports())}};
+}
+
+void JobServer::_portChanged(QString const& port, bool present) {
+    if(!present) {
+        // A running job notices the loss by itself, an idle connection is simply dropped.
+        auto busy = std::any_of(_jobs.cbegin(), _jobs.cend(), [&port](std::shared_ptr<Job> const& job) {
+            return job->port == port && job->runner && !isFinal(job->state);
+        });
+        if(!busy) {
+            _engravers.remove(port);
+        }
+    } else {
+        _schedule(port);
+    }
+    _broadcast(QJsonObject{{"event", "port"}, {"port", port}, {"present", present}});
+}
+
+void JobServer::_preprocessed(std::shared_ptr<Job> const& job) {
+    if(isFinal(job->state)) {
+        // The watcher is still emitting its signal, so the job is retired later on.
+        QTimer::singleShot(0, this, [this, job] { _retire(job); });
+        return;
+    }
+    job->bitmap = job->preprocessing->result();
+    if(job->bitmap.isNull()) {
+        _fail(job, "failed to load image");
+        return;
+    }
+
+    _setState(job, "queued");
+    _scheduleAll(job);
+}
+
+void JobServer::_schedule(QString const& port) {
+    // Jobs for a port that is not plugged in stay queued until the port is added.
+    if(!_portWatcher.ports().contains(port)) {
+        return;
+    }
+
+    // Watched jobs are not bound to a port and run on the first watched port present and idle.
+    auto const takesWatched = _watchPorts.contains(port);
+    std::shared_ptr<Job> next{};
+    for(auto const& job : _jobs) {
+        if(job->port == port && job->runner && !isFinal(job->state)) {
+            return;
+        }
+        if(job->port != port && !(job->port.isEmpty() && takesWatched)) {
+            continue;
+        }
+        // Jobs are iterated by id, hence the earliest job wins among equal priorities.
+        if(job->state == "queued" && (!next || job->priority > next->priority)) {
+            next = job;
+        }
+    }
+
+    if(next) {
+        next->port = port;
+        _run(next);
+    }
+}
+
+void JobServer::_scheduleAll(std::shared_ptr<Job> const& job) {
+    if(!job->port.isEmpty()) {
+        _schedule(job->port);
+        return;
+    }
+    for(auto const& port : _watchPorts) {
+        _schedule(port);
+    }
+}
+
+void JobServer::_run(std::shared_ptr<Job> const& job) {
+    auto engraver = _engravers.value(job->port, nullptr);
+    if(!engraver) {
+        try {
+            engraver = EzGraver::create(job->port);
+            _engravers.insert(job->port, engraver);
+        } catch(std::runtime_error const& e) {
+            _fail(job, e.what());
+            QTimer::singleShot(0, this, [this, job] { _schedule(job->port); });
+            return;
+        }
+    }
+
+    job->runner = std::make_shared<EngraveJob>(engraver, job->bitmap, job->burnTime);
+    auto runner = job->runner.get();
+    connect(runner, &EngraveJob::stateChanged, this, [this, job](EngraveJob::State state) {
+        _setState(job, EngraveJob::stateName(state));
+    });
+
+    auto lastProgress = std::make_shared<qint64>(-ProgressEventDelay);
+    auto progress = [this, job, lastProgress] {
+        auto elapsed = job->runner->elapsed();
+        if(elapsed - *lastProgress < ProgressEventDelay) {
+            return;
+        }
+        *lastProgress = elapsed;
+        auto event = _describe(*job);
+        event["event"] = "progress";
+        _broadcast(event);
+    };
+    connect(runner, &EngraveJob::uploadProgressed, this, progress);
+    connect(runner, &EngraveJob::pixelBurned, this, progress);
+
+    connect(runner, &EngraveJob::finished, this, [this, job](bool) {
+        if(job->state == "failed") {
+            // The connection is most likely broken, the next job reconnects.
+            _engravers.remove(job->port);
+        }
+        QTimer::singleShot(0, this, [this, job] { _schedule(job->port); });
+    });
+
+    job->runner->start();
+}
+
+void JobServer::_setState(std::shared_ptr<Job> const& job, QString const& state) {
+    qDebug() << "job" << job->id << "changed state to" << state;
+    job->state = state;
+    auto event = _describe(*job);
+    event["event"] = "state";
+    _broadcast(event);
+
+    if(job->watched && isFinal(state)) {
+        auto record = _describe(*job);
+        record["submitted"] = job->submitted.toString(Qt::ISODate);
+        record["finished"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+        auto archived = FolderWatcher::archive(job->fileName, state == "completed", record);
+        if(!archived.isEmpty()) {
+            job->fileName = archived;
+        }
+    }
+    if(isFinal(state)) {
+        // The runner may still be emitting the state change, so it is released later on.
+        QTimer::singleShot(0, this, [this, job] { _retire(job); });
+    }
+}
+
+void JobServer::_retire(std::shared_ptr<Job> const& job) {
+    // The final progress is kept for queries, everything else held by the job is released.
+    if(job->runner) {
+        auto const description = _describe(*job);
+        for(auto const key : {"bytesSent", "bytesTotal", "burned", "burnCount"}) {
+            job->progress[key] = description[key];
+        }
+        job->runner.reset();
+    }
+    if(job->preprocessing && job->preprocessing->isFinished()) {
+        job->preprocessing.reset();
+    }
+    job->bitmap = QImage{};
+
+    // Jobs are ordered by id, hence the oldest finished jobs are dropped first.
+    auto finished = std::count_if(_jobs.cbegin(), _jobs.cend(), [](std::shared_ptr<Job> const& job) {
+        return isFinal(job->state);
+    });
+    for(auto it = _jobs.begin(); it != _jobs.end() && finished > MaxFinishedJobs;) {
+        if(isFinal(it.value()->state) && !it.value()->preprocessing) {
+            it = _jobs.erase(it);
+            --finished;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void JobServer::_fail(std::shared_ptr<Job> const& job, QString const& error) {
+    job->error = error;
+    _setState(job, "failed");
+}
+
+QJsonObject JobServer::_describe(Job const& job) const {
+    QJsonObject description{
+        {"id", job.id},
+        {"port", job.port},
+        {"image", job.fileName},
+        {"burnTime", job.burnTime},
+        {"priority", job.priority},
+        {"state", job.state}
+    };
+    if(!job.error.isEmpty()) {
+        description["error"] = job.error;
+    }
+    if(job.runner) {
+        description["bytesSent"] = static_cast<double>(job.runner->bytesSent());
+        description["bytesTotal"] = static_cast<double>(job.runner->bytesTotal());
+        description["burned"] = job.runner->burnedCount();
+        description["burnCount"] = job.runner->burnCount();
+        description["eta"] = job.runner->remainingTime();
+    } else {
+        for(auto it = job.progress.constBegin(); it != job.progress.constEnd(); ++it) {
+            description[it.key()] = it.value();
+        }
+    }
+    return description;
+}
+
+void JobServer::_send(QLocalSocket* client, QJsonObject const& object) {
+    client->write(QJsonDocument{object}.toJson(QJsonDocument::Compact));
+    client->write("\n");
+}
+
+void JobServer::_broadcast(QJsonObject const& object) {
+    for(auto client : _clients) {
+        _send(client, object);
+    }
+}
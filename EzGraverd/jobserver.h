@@ -0,0 +1,117 @@
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QFutureWatcher>
+#include <QJsonObject>
+#include <QImage>
+#include <QDateTime>
+#include <QList>
+#include <QMap>
+
+#include <memory>
+
+#include "ezgraver.h"
+#include "engravejob.h"
+#include "portwatcher.h"
+#include "folderwatcher.h"
+
+/*!
+ * Owns the connections to all engravers and runs the submitted jobs. Clients connect
+ * through a local socket and exchange JSON objects, one per line. Jobs are preprocessed
+ * as soon as they have been submitted and are run by priority once their engraver is idle.
+ */
+class JobServer : public QObject {
+    Q_OBJECT
+
+public:
+    /*! The name of the local socket used if none has been specified. */
+    static QString const DefaultSocketName;
+
+    /*!
+     * Creates a new instance with the given \a parent.
+     *
+     * \param parent The parent of the server.
+     */
+    explicit JobServer(QObject* parent=NULL);
+
+    /*!
+     * Frees all required resources upon deconstruction.
+     */
+    virtual ~JobServer();
+
+    /*!
+     * Starts listening for clients on the local socket with the given \a name. A socket
+     * left behind by a crashed daemon is replaced, a socket still served is not.
+     *
+     * \param name The name of the local socket.
+     * \return \c true if the server is listening.
+     */
+    bool listen(QString const& name);
+
+    /*!
+     * Watches the given \a directory and submits every completed image as job, which
+     * runs on the first of the given \a ports to become idle. Finished images are
+     * moved to the done or failed subdirectory along with a JSON record of the job.
+     *
+     * \param directory The directory to watch.
+     * \param ports The ports the jobs may run on.
+     * \param burnTime The burn time of the jobs.
+     * \return \c true if the directory is watched.
+     */
+    bool watch(QString const& directory, QStringList const& ports, int burnTime);
+
+private:
+    /*! A submitted job including its current processing state. */
+    struct Job {
+        int id;
+        QString port;
+        QString fileName;
+        int burnTime;
+        int priority;
+        QString state;
+        QString error;
+        QImage bitmap;
+        std::shared_ptr<QFutureWatcher<QImage>> preprocessing;
+        std::shared_ptr<EngraveJob> runner;
+        bool watched;
+        QDateTime submitted;
+        QJsonObject progress;
+    };
+
+    QLocalServer _server;
+    QList<QLocalSocket*> _clients;
+    QMap<int, std::shared_ptr<Job>> _jobs;
+    QMap<QString, std::shared_ptr<EzGraver>> _engravers;
+    PortWatcher _portWatcher;
+    std::unique_ptr<FolderWatcher> _folderWatcher;
+    QStringList _watchPorts;
+    int _watchBurnTime;
+    int _nextId;
+
+    void _newConnection();
+    void _readClient(QLocalSocket* client);
+    QJsonObject _handleRequest(QJsonObject const& request);
+    QJsonObject _submit(QJsonObject const& request);
+    std::shared_ptr<Job> _enqueue(QString const& port, QString const& fileName, int burnTime, int priority, bool watched);
+    QJsonObject _cancel(QJsonObject const& request);
+    QJsonObject _query(QJsonObject const& request) const;
+    QJsonObject _ports() const;
+    void _portChanged(QString const& port, bool present);
+
+    void _preprocessed(std::shared_ptr<Job> const& job);
+    void _schedule(QString const& port);
+    void _scheduleAll(std::shared_ptr<Job> const& job);
+    void _run(std::shared_ptr<Job> const& job);
+    void _setState(std::shared_ptr<Job> const& job, QString const& state);
+    void _fail(std::shared_ptr<Job> const& job, QString const& error);
+    void _retire(std::shared_ptr<Job> const& job);
+
+    QJsonObject _describe(Job const& job) const;
+    void _send(QLocalSocket* client, QJsonObject const& object);
+    void _broadcast(QJsonObject const& object);
+};
+
+#endif // JOBSERVER_H
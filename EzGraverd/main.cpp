@@ -0,0 +1,51 @@
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QStringList>
+
+#include <iostream>
+
+#include "jobserver.h"
+#include "imageloader.h"
+
+int main(int argc, char* argv[]) {
+    // Text within vector images needs the font database of a GUI application.
+    ImageLoader::useOffscreenPlatform();
+    QGuiApplication app{argc, argv};
+
+    QCommandLineParser parser{};
+    parser.addHelpOption();
+    parser.addPositionalArgument("socket", "The name of the local socket.", "[socket name]");
+    QCommandLineOption watchOption{"watch", "Engraves every image dropped into <directory>.", "directory"};
+    QCommandLineOption portsOption{"ports", "The comma separated <ports> watched images are engraved on.", "ports"};
+    QCommandLineOption burnTimeOption{"burn-time", "The burn time of watched images.", "burn time", "60"};
+    parser.addOption(watchOption);
+    parser.addOption(portsOption);
+    parser.addOption(burnTimeOption);
+    parser.process(app);
+
+    auto arguments = parser.positionalArguments();
+    auto socketName = !arguments.isEmpty() ? arguments[0] : JobServer::DefaultSocketName;
+
+    JobServer server{};
+    if(!server.listen(socketName)) {
+        std::cerr << "Error: failed to listen on socket '" << socketName.toStdString() << "'\n";
+        return 1;
+    }
+
+    if(parser.isSet(watchOption)) {
+        auto ports = parser.value(portsOption).split(',', QString::SkipEmptyParts);
+        auto burnTime = parser.value(burnTimeOption).toInt();
+        if(ports.isEmpty() || burnTime < 1 || burnTime > 0xF0) {
+            std::cerr << "Error: watching requires at least one port and a burn time from 1 to 240\n";
+            return 1;
+        }
+        if(!server.watch(parser.value(watchOption), ports, burnTime)) {
+            std::cerr << "Error: failed to watch '" << parser.value(watchOption).toStdString() << "'\n";
+            return 1;
+        }
+        std::cout << "watching '" << parser.value(watchOption).toStdString() << "'\n";
+    }
+
+    std::cout << "EzGraverd " << EZ_VERSION << " listening on '" << socketName.toStdString() << "'\n";
+    return app.exec();
+}